@@ -1,25 +1,51 @@
 #pragma once
 
+#include "error.hpp"
 #include "geometry.hpp"
+#include "object.hpp"
+#include "options.hpp"
+#include "subscription.hpp"
 
 #include <boost/cobalt/promise.hpp>
+#include <boost/cobalt/task.hpp>
 #include <msgpack.hpp>
 
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <functional>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace rpc {
+class Cancellation;
 class Client;
+struct CallOptions;
 }
 namespace nvim {
 
+class Batch;
+
+// Connection a call goes through. Bulk transfers, like reading a whole buffer or a large batch of extmarks,
+// can use a second connection to Neovim, so they don't hold back the small calls made for an editor event.
+enum class Lane { Interactive, Bulk };
+
 class Api {
-    std::shared_ptr<rpc::Client> rpc_;
-    int notification_id_cnt_{0};
+    // connections shared by all copies of the api
+    struct Lanes;
+
+    std::shared_ptr<Lanes> lanes_;
+    std::shared_ptr<rpc::Client> rpc_;  // lane of the calls made through this object
+    rpc::Cancellation* cancellation_{}; // of the calls made through this object, if any
 
-    Api(std::string host, std::uint16_t port);
+    explicit Api(std::string_view address);
+
+    auto options() const -> rpc::CallOptions;
 
 public:
     template <typename T>
@@ -28,23 +54,282 @@ public:
     template <typename T>
     using generator = boost::cobalt::generator<T>;
 
+    template <typename T>
+    using task = boost::cobalt::task<T>;
+
     using integer = int;
     using number = int;
     using boolean = bool;
     using string = std::string;
     using any = msgpack::type::variant;
+    using view = rpc::ObjectView;
 
     template <typename K, typename V>
     using table = std::multimap<K, V>;
 
     using function = std::function<void(any)>; // TODO: implement
 
+    // address is "host:port", a unix socket path or "stdio", see `rpc::Address`
+    static auto create(std::string address) -> promise<Api>;
     static auto create(std::string host, std::uint16_t port) -> promise<Api>;
 
+    // channel of the interactive lane, notifications are always sent to it
     auto rpc_channel() const -> int;
+
+    // Opens the bulk lane, a second connection to the same Neovim. Without it bulk calls use the interactive lane,
+    // which is also the case for "stdio", it can't be connected twice.
+    auto open_bulk_lane() -> promise<void>;
+
+    // Api which makes its calls on the given lane. Subscriptions, autocmds and served requests stay on the
+    // interactive lane whichever lane they are made from, so their ids and channel are the same for all copies.
+    auto lane(Lane lane) const -> Api;
+
+    // Api whose calls, batches included, are abandoned by `cancellation.cancel()`: they throw `rpc::CancelledError`
+    // or return it from the `try_*` variants. The cancellation must outlive the calls. Such calls are not cached.
+    auto cancellable(rpc::Cancellation& cancellation) const -> Api;
+
+    // Writes all RPC traffic of the interactive lane to a file, see `rpc::Recorder` for the format
+    auto record(const std::string& path) -> void;
+
+    // Deadline of every call, a call past it throws `rpc::TimeoutError`. Zero, the default, waits forever.
+    auto set_timeout(std::chrono::milliseconds timeout) -> void;
+
+    // Read-only calls which are deduplicated by `enable_single_flight()` unless it's given its own list
+    static auto read_only_methods() -> std::set<std::string, std::less<>>;
+
+    // Identical calls of the given methods made while one is in flight share its response, on all lanes.
+    // Methods with side effects must not be listed, their repeated calls would be lost.
+    auto enable_single_flight(std::set<std::string, std::less<>> methods = read_only_methods()) -> void;
+
+    // Events which can move or resize windows, the cached window geometry of the state cache and of `Graphics`
+    // is dropped on them
+    static auto layout_events() -> std::vector<std::string>;
+
+    // Methods and helpers whose results are cached by `enable_state_cache()` and the events which invalidate them
+    static auto state_cache_policy() -> std::map<std::string, std::vector<std::string>, std::less<>>;
+
+    // Caches editor state on the interactive lane until an event changes it, so repeated reads cost no round trip.
+    // Registers an autocmd in the augroup for the events of the policy, caching starts once it is in place.
+    auto enable_state_cache(integer augroup) -> promise<void>;
+
+    // Per-method call counters and latency percentiles, followed by the notification counters of the subscriptions
+    auto metrics_report() const -> std::string;
     auto next_notification_id() -> int;
-    auto notification(std::uint32_t id) -> promise<any>;
-    auto notifications(std::uint32_t id) -> generator<any>;
+    auto notification(std::uint32_t id) -> promise<view>;
+    auto notifications(std::uint32_t id, rpc::SubscriptionOptions options = {}) -> generator<view>;
+
+    // Serves `rpcrequest(channel, method, ...)` calls from Lua, the handler gets the call arguments.
+    // Requests are handled concurrently, the result or the error of the handler is sent back to the caller.
+    auto serve(std::string method, std::function<task<any>(view args)> handler) -> void;
+
+    // First and last line shown in the window, one-based
+    auto visible_lines(integer window) -> promise<VisibleLines>;
+
+    // Adds or removes a buffer of an allowlist which `EventFilter::buffers` refers to by name
+    auto allow_buffer(string allowlist, integer buffer, boolean allowed = true) -> promise<void>;
+
+    // Screen cell of the window, one-based, and the offsets of its first text cell from it: the winbar, number and
+    // sign columns and the border of a float. Only the offsets are filled in if asked for.
+    auto window_origin(integer window, boolean offsets_only = false) -> promise<WindowOrigin>;
+
+    // Writes a query to the terminal Neovim runs in and returns the reply, which ends with the first match of the
+    // Lua pattern `reply`. Queries are answered as soon as the terminal replies, empty if it didn't within timeout.
+    auto terminal_query(string query, string reply, std::chrono::milliseconds timeout) -> promise<string>;
+
+    // Process id of Neovim
+    auto nvim_pid() -> promise<integer>;
+
+    // Starts a batch of calls which are sent to Neovim as one `nvim_call_atomic()` request
+    auto batch() -> Batch;
+
+    // Non-throwing variants of the calls below, for calls which fail in normal operation, e.g. on a mark that was
+    // deleted already. A failed call returns Neovim's error type and message instead of throwing, which costs no
+    // exception. Same arguments and results as the throwing calls, see there for the documentation.
+    auto try_nvim_buf_add_highlight(integer buffer, integer ns_id, string hl_group, integer line, integer col_start,
+                                    integer col_end) -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_attach(integer buffer, boolean send_buffer, table<string, any> opts)
+        -> promise<rpc::Result<boolean>>;
+    auto try_nvim_buf_call(integer buffer, function) -> promise<rpc::Result<any>>;
+    auto try_nvim_buf_clear_highlight(integer buffer, integer ns_id, integer line_start, integer line_end)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_clear_namespace(integer buffer, integer ns_id, integer line_start, integer line_end)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_create_user_command(integer buffer, string name, any command, table<string, any> opts)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_del_extmark(integer buffer, integer ns_id, integer id) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_buf_del_keymap(integer buffer, string mode, string lhs) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_del_mark(integer buffer, string name) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_buf_del_user_command(integer buffer, string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_del_var(integer buffer, string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_delete(integer buffer, table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_get_changedtick(integer buffer) -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_get_commands(integer buffer, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_buf_get_extmark_by_id(integer buffer, integer ns_id, integer id, table<string, any> opts)
+        -> promise<rpc::Result<any>>;
+    auto try_nvim_buf_get_extmarks(integer buffer, integer ns_id, any start, any end_, table<string, any> opts)
+        -> promise<rpc::Result<std::vector<any>>>;
+    auto try_nvim_buf_get_keymap(integer buffer, string mode) -> promise<rpc::Result<std::vector<table<string, any>>>>;
+    auto try_nvim_buf_get_lines(integer buffer, integer start, integer end_, boolean strict_indexing)
+        -> promise<rpc::Result<std::vector<string>>>;
+    auto try_nvim_buf_get_mark(integer buffer, string name) -> promise<rpc::Result<std::vector<integer>>>;
+    auto try_nvim_buf_get_name(integer buffer) -> promise<rpc::Result<string>>;
+    auto try_nvim_buf_get_number(integer buffer) -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_get_offset(integer buffer, integer index) -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_get_option(integer buffer, string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_buf_get_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                               table<string, any> opts) -> promise<rpc::Result<std::vector<string>>>;
+    auto try_nvim_buf_get_var(integer buffer, string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_buf_is_loaded(integer buffer) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_buf_is_valid(integer buffer) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_buf_line_count(integer buffer) -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
+        -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, ExtmarkOpts opts)
+        -> promise<rpc::Result<integer>>;
+    auto try_nvim_buf_set_keymap(integer buffer, string mode, string lhs, string rhs, table<string, any> opts)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_set_lines(integer buffer, integer start, integer end_, boolean strict_indexing,
+                                std::vector<string> replacement) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_set_mark(integer buffer, string name, integer line, integer col, table<string, any> opts)
+        -> promise<rpc::Result<boolean>>;
+    auto try_nvim_buf_set_name(integer buffer, string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_set_option(integer buffer, string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_set_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                               std::vector<string> replacement) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_set_var(integer buffer, string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_buf_set_virtual_text(integer buffer, integer src_id, integer line, std::vector<any> chunks,
+                                       table<string, any> opts) -> promise<rpc::Result<integer>>;
+    auto try_nvim_call_dict_function(any dict, string fn, std::vector<any> args) -> promise<rpc::Result<any>>;
+    auto try_nvim_call_function(string fn, std::vector<any> args) -> promise<rpc::Result<any>>;
+    auto try_nvim_chan_send(integer chan, string data) -> promise<rpc::Result<void>>;
+    auto try_nvim_clear_autocmds(table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_cmd(table<string, any> cmd, table<string, any> opts) -> promise<rpc::Result<string>>;
+    auto try_nvim_command(string command) -> promise<rpc::Result<void>>;
+    auto try_nvim_command_output(string command) -> promise<rpc::Result<string>>;
+    auto try_nvim_complete_set(integer index, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_create_augroup(string name, table<string, any> opts) -> promise<rpc::Result<integer>>;
+    auto try_nvim_create_buf(boolean listed, boolean scratch) -> promise<rpc::Result<integer>>;
+    auto try_nvim_create_namespace(string name) -> promise<rpc::Result<integer>>;
+    auto try_nvim_create_user_command(string name, any command, table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_del_augroup_by_id(integer id) -> promise<rpc::Result<void>>;
+    auto try_nvim_del_augroup_by_name(string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_del_autocmd(integer id) -> promise<rpc::Result<void>>;
+    auto try_nvim_del_current_line() -> promise<rpc::Result<void>>;
+    auto try_nvim_del_keymap(string mode, string lhs) -> promise<rpc::Result<void>>;
+    auto try_nvim_del_mark(string name) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_del_user_command(string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_del_var(string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_echo(std::vector<any> chunks, boolean history, table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_err_write(string str) -> promise<rpc::Result<void>>;
+    auto try_nvim_err_writeln(string str) -> promise<rpc::Result<void>>;
+    auto try_nvim_eval(string expr) -> promise<rpc::Result<any>>;
+    auto try_nvim_eval_statusline(string str, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_exec(string src, boolean output) -> promise<rpc::Result<string>>;
+    auto try_nvim_exec2(string src, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_exec2(string src, Exec2Opts opts) -> promise<rpc::Result<Exec2Result>>;
+    auto try_nvim_exec_autocmds(any event, table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_feedkeys(string keys, string mode, boolean escape_ks) -> promise<rpc::Result<void>>;
+    auto try_nvim_get_all_options_info() -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_autocmds(table<string, any> opts) -> promise<rpc::Result<std::vector<any>>>;
+    auto try_nvim_get_chan_info(integer chan) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_color_by_name(string name) -> promise<rpc::Result<integer>>;
+    auto try_nvim_get_color_map() -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_commands(table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_context(table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_current_buf() -> promise<rpc::Result<integer>>;
+    auto try_nvim_get_current_line() -> promise<rpc::Result<string>>;
+    auto try_nvim_get_current_tabpage() -> promise<rpc::Result<integer>>;
+    auto try_nvim_get_current_win() -> promise<rpc::Result<integer>>;
+    auto try_nvim_get_hl(integer ns_id, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_hl_by_id(integer hl_id, boolean rgb) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_hl_by_name(string name, boolean rgb) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_hl_id_by_name(string name) -> promise<rpc::Result<integer>>;
+    auto try_nvim_get_hl_ns(table<string, any> opts) -> promise<rpc::Result<integer>>;
+    auto try_nvim_get_keymap(string mode) -> promise<rpc::Result<std::vector<table<string, any>>>>;
+    auto try_nvim_get_mark(string name, table<string, any> opts) -> promise<rpc::Result<std::vector<any>>>;
+    auto try_nvim_get_mode() -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_namespaces() -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_option(string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_get_option_info(string name) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_option_info2(string name, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_get_option_value(string name, table<string, any> opts) -> promise<rpc::Result<any>>;
+    auto try_nvim_get_proc(integer pid) -> promise<rpc::Result<any>>;
+    auto try_nvim_get_proc_children(integer pid) -> promise<rpc::Result<std::vector<any>>>;
+    auto try_nvim_get_runtime_file(string name, boolean all) -> promise<rpc::Result<std::vector<string>>>;
+    auto try_nvim_get_var(string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_get_vvar(string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_input(string keys) -> promise<rpc::Result<integer>>;
+    auto try_nvim_input_mouse(string button, string action, string modifier, integer grid, integer row, integer col)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_list_bufs() -> promise<rpc::Result<std::vector<integer>>>;
+    auto try_nvim_list_chans() -> promise<rpc::Result<std::vector<any>>>;
+    auto try_nvim_list_runtime_paths() -> promise<rpc::Result<std::vector<string>>>;
+    auto try_nvim_list_tabpages() -> promise<rpc::Result<std::vector<integer>>>;
+    auto try_nvim_list_uis() -> promise<rpc::Result<std::vector<any>>>;
+    auto try_nvim_list_wins() -> promise<rpc::Result<std::vector<integer>>>;
+    auto try_nvim_load_context(table<string, any> dict) -> promise<rpc::Result<any>>;
+    auto try_nvim_notify(string msg, integer log_level, table<string, any> opts) -> promise<rpc::Result<any>>;
+    auto try_nvim_open_term(integer buffer, table<string, any> opts) -> promise<rpc::Result<integer>>;
+    auto try_nvim_open_win(integer buffer, boolean enter, table<string, any> config) -> promise<rpc::Result<integer>>;
+    auto try_nvim_out_write(string str) -> promise<rpc::Result<void>>;
+    auto try_nvim_parse_cmd(string str, table<string, any> opts) -> promise<rpc::Result<any>>;
+    auto try_nvim_parse_expression(string expr, string flags, boolean highlight)
+        -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_paste(string data, boolean crlf, integer phase) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_put(std::vector<string> lines, string type, boolean after, boolean follow)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_replace_termcodes(string str, boolean from_part, boolean do_lt, boolean special)
+        -> promise<rpc::Result<string>>;
+    auto try_nvim_select_popupmenu_item(integer item, boolean insert, boolean finish, table<string, any> opts)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_set_current_buf(integer buffer) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_current_dir(string dir) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_current_line(string line) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_current_tabpage(integer tabpage) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_current_win(integer window) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_decoration_provider(integer ns_id, table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_hl(integer ns_id, string name, table<string, any> val) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_hl_ns(integer ns_id) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_hl_ns_fast(integer ns_id) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_keymap(string mode, string lhs, string rhs, table<string, any> opts)
+        -> promise<rpc::Result<void>>;
+    auto try_nvim_set_option(string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_option_value(string name, any value, table<string, any> opts) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_var(string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_set_vvar(string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_strwidth(string text) -> promise<rpc::Result<integer>>;
+    auto try_nvim_tabpage_del_var(integer tabpage, string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_tabpage_get_number(integer tabpage) -> promise<rpc::Result<integer>>;
+    auto try_nvim_tabpage_get_var(integer tabpage, string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_tabpage_get_win(integer tabpage) -> promise<rpc::Result<integer>>;
+    auto try_nvim_tabpage_is_valid(integer tabpage) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_tabpage_list_wins(integer tabpage) -> promise<rpc::Result<std::vector<integer>>>;
+    auto try_nvim_tabpage_set_var(integer tabpage, string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_tabpage_set_win(integer tabpage, integer win) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_call(integer window, function) -> promise<rpc::Result<any>>;
+    auto try_nvim_win_close(integer window, boolean force) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_del_var(integer window, string name) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_get_buf(integer window) -> promise<rpc::Result<integer>>;
+    auto try_nvim_win_get_config(integer window) -> promise<rpc::Result<table<string, any>>>;
+    auto try_nvim_win_get_cursor(integer window) -> promise<rpc::Result<std::vector<integer>>>;
+    auto try_nvim_win_get_height(integer window) -> promise<rpc::Result<integer>>;
+    auto try_nvim_win_get_number(integer window) -> promise<rpc::Result<integer>>;
+    auto try_nvim_win_get_option(integer window, string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_win_get_position(integer window) -> promise<rpc::Result<Point>>;
+    auto try_nvim_win_get_tabpage(integer window) -> promise<rpc::Result<integer>>;
+    auto try_nvim_win_get_var(integer window, string name) -> promise<rpc::Result<any>>;
+    auto try_nvim_win_get_width(integer window) -> promise<rpc::Result<integer>>;
+    auto try_nvim_win_hide(integer window) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_is_valid(integer window) -> promise<rpc::Result<boolean>>;
+    auto try_nvim_win_set_buf(integer window, integer buffer) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_config(integer window, table<string, any> config) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_cursor(integer window, std::vector<integer> pos) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_height(integer window, integer height) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_hl_ns(integer window, integer ns_id) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_option(integer window, string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_var(integer window, string name, any value) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_set_width(integer window, integer width) -> promise<rpc::Result<void>>;
+    auto try_nvim_win_text_height(integer window, table<string, any> opts) -> promise<rpc::Result<table<string, any>>>;
 
     // Adds a highlight to buffer.
     // Useful for plugins that dynamically generate highlights to a buffer (like
@@ -560,6 +845,10 @@ public:
     auto nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
         -> promise<integer>;
 
+    // Same as above with typed options, packed straight into the request.
+    auto nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, ExtmarkOpts opts)
+        -> promise<integer>;
+
     // Sets a buffer-local `mapping` for the given mode.
     //
     // @param buffer integer Buffer handle, or 0 for current buffer
@@ -835,7 +1124,19 @@ public:
     //              • nested (boolean) optional: defaults to false. Run nested
     //                autocommands `autocmd-nested`.
     // @return integer
-    auto nvim_create_autocmd(std::vector<std::string> event, table<any, any> opts) -> generator<any>;
+    //
+    // The callback is replaced with a notification to this client, the generator yields the `ev` tables.
+    // `subscription` sets the queue limit and overflow policy for when the consumer falls behind.
+    auto nvim_create_autocmd(std::vector<std::string> event, table<any, any> opts,
+                             rpc::SubscriptionOptions subscription = {}) -> generator<view>;
+
+    // Same as above with typed options, packed straight into the request.
+    auto nvim_create_autocmd(std::vector<std::string> event, AutocmdOpts opts,
+                             rpc::SubscriptionOptions subscription = {}) -> generator<view>;
+
+    // Same as above, events are filtered, projected and rate limited in Neovim before they are sent
+    auto nvim_create_autocmd(std::vector<std::string> event, AutocmdOpts opts, EventFilter filter,
+                             rpc::SubscriptionOptions subscription = {}) -> generator<view>;
 
     // Creates a new, empty, unnamed buffer.
     //
@@ -1031,6 +1332,9 @@ public:
     // @return table<string,any>
     auto nvim_exec2(string src, table<string, any> opts) -> promise<table<string, any>>;
 
+    // Same as above with typed options and result.
+    auto nvim_exec2(string src, Exec2Opts opts) -> promise<Exec2Result>;
+
     // Execute all autocommands for {event} that match the corresponding {opts}
     // `autocmd-execute`.
     //
@@ -2114,5 +2418,278 @@ public:
     //                 omitted include the whole line.
     // @return table<string,any>
     auto nvim_win_text_height(integer window, table<string, any> opts) -> promise<table<string, any>>;
+
+private:
+    template <typename Opts>
+    auto create_autocmd(std::vector<std::string> event, Opts opts, EventFilter filter,
+                        rpc::SubscriptionOptions subscription) -> generator<view>;
+
+    // calls a function of the Lua helper module, see `api.cpp`
+    template <typename T, typename... Args>
+    auto call_helper(const char* name, Args... args) -> promise<T>;
+};
+
+namespace detail {
+
+// decodes a result straight from the received message, handles come as EXT types
+template <typename T>
+auto decode(const Api::view& value) -> T {
+    if constexpr (std::is_same_v<T, Api::integer>) {
+        return value.as<rpc::Handle>().id;
+    } else if constexpr (std::is_same_v<T, std::vector<Api::integer>>) {
+        const auto handles = value.as<std::vector<rpc::Handle>>();
+        return T(handles.begin(), handles.end());
+    } else if constexpr (std::is_same_v<T, Point>) {
+        const auto [row, col] = value.as<std::array<Api::integer, 2>>();
+        return Point{.x = col, .y = row};
+    } else {
+        return value.as<T>();
+    }
+}
+
+} // namespace detail
+
+// Records API calls and sends them to Neovim as a single `nvim_call_atomic()` request.
+// Every recorded call returns a `Result` which holds the typed value once `execute()` has finished.
+// Neovim stops at the first failing call: its `Result` reports the error and calls after it are not executed.
+class Batch {
+    struct State {
+        msgpack::sbuffer calls;
+        std::size_t count{};
+        bool executed{};
+        Api::view results;
+        std::size_t error_index{};
+        std::string error;
+
+        auto value(std::size_t index) const -> Api::view;
+    };
+
+    std::shared_ptr<rpc::Client> rpc_;
+    rpc::Cancellation* cancellation_{};
+    std::shared_ptr<State> state_;
+
+public:
+    using integer = Api::integer;
+    using boolean = Api::boolean;
+    using string = Api::string;
+    using any = Api::any;
+
+    template <typename K, typename V>
+    using table = Api::table<K, V>;
+
+    template <typename T>
+    class Result {
+        std::shared_ptr<const State> state_;
+        std::size_t index_{};
+
+    public:
+        Result(std::shared_ptr<const State> state, std::size_t index)
+            : state_{std::move(state)}
+            , index_{index} {}
+
+        // returns result of the call, throws if the call failed or was not executed
+        auto get() const -> T {
+            if constexpr (std::is_void_v<T>) {
+                state_->value(index_);
+            } else {
+                return detail::decode<T>(state_->value(index_));
+            }
+        }
+    };
+
+    explicit Batch(std::shared_ptr<rpc::Client> rpc, rpc::Cancellation* cancellation = nullptr);
+
+    auto size() const -> std::size_t;
+
+    // sends all recorded calls, results become available when it's done
+    auto execute() -> Api::promise<void>;
+
+    template <typename T, typename... Args>
+    auto add(const rpc::Name& method, const Args&... args) -> Result<T> {
+        // every call is packed as [method, [args...]]
+        msgpack::packer<msgpack::sbuffer> pk(&state_->calls);
+        pk.pack_array(2);
+        pk.pack_bin_body(method.packed().data(), method.packed().size());
+        pk.pack_array(sizeof...(args));
+        (pk.pack(args), ...);
+        return Result<T>{state_, state_->count++};
+    }
+
+    // Same calls as in `Api`, see there for the documentation.
+    auto nvim_buf_add_highlight(integer buffer, integer ns_id, string hl_group, integer line, integer col_start,
+                                integer col_end) -> Result<integer>;
+    auto nvim_buf_attach(integer buffer, boolean send_buffer, table<string, any> opts) -> Result<boolean>;
+    auto nvim_buf_clear_highlight(integer buffer, integer ns_id, integer line_start, integer line_end) -> Result<void>;
+    auto nvim_buf_clear_namespace(integer buffer, integer ns_id, integer line_start, integer line_end) -> Result<void>;
+    auto nvim_buf_create_user_command(integer buffer, string name, any command, table<string, any> opts)
+        -> Result<void>;
+    auto nvim_buf_del_extmark(integer buffer, integer ns_id, integer id) -> Result<boolean>;
+    auto nvim_buf_del_keymap(integer buffer, string mode, string lhs) -> Result<void>;
+    auto nvim_buf_del_mark(integer buffer, string name) -> Result<boolean>;
+    auto nvim_buf_del_user_command(integer buffer, string name) -> Result<void>;
+    auto nvim_buf_del_var(integer buffer, string name) -> Result<void>;
+    auto nvim_buf_delete(integer buffer, table<string, any> opts) -> Result<void>;
+    auto nvim_buf_get_changedtick(integer buffer) -> Result<integer>;
+    auto nvim_buf_get_commands(integer buffer, table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_buf_get_extmark_by_id(integer buffer, integer ns_id, integer id, table<string, any> opts) -> Result<any>;
+    auto nvim_buf_get_extmarks(integer buffer, integer ns_id, any start, any end_, table<string, any> opts)
+        -> Result<std::vector<any>>;
+    auto nvim_buf_get_keymap(integer buffer, string mode) -> Result<std::vector<table<string, any>>>;
+    auto nvim_buf_get_lines(integer buffer, integer start, integer end_, boolean strict_indexing)
+        -> Result<std::vector<string>>;
+    auto nvim_buf_get_mark(integer buffer, string name) -> Result<std::vector<integer>>;
+    auto nvim_buf_get_name(integer buffer) -> Result<string>;
+    auto nvim_buf_get_number(integer buffer) -> Result<integer>;
+    auto nvim_buf_get_offset(integer buffer, integer index) -> Result<integer>;
+    auto nvim_buf_get_option(integer buffer, string name) -> Result<any>;
+    auto nvim_buf_get_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                           table<string, any> opts) -> Result<std::vector<string>>;
+    auto nvim_buf_get_var(integer buffer, string name) -> Result<any>;
+    auto nvim_buf_is_loaded(integer buffer) -> Result<boolean>;
+    auto nvim_buf_is_valid(integer buffer) -> Result<boolean>;
+    auto nvim_buf_line_count(integer buffer) -> Result<integer>;
+    auto nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
+        -> Result<integer>;
+    auto nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, ExtmarkOpts opts)
+        -> Result<integer>;
+    auto nvim_buf_set_keymap(integer buffer, string mode, string lhs, string rhs, table<string, any> opts)
+        -> Result<void>;
+    auto nvim_buf_set_lines(integer buffer, integer start, integer end_, boolean strict_indexing,
+                            std::vector<string> replacement) -> Result<void>;
+    auto nvim_buf_set_mark(integer buffer, string name, integer line, integer col, table<string, any> opts)
+        -> Result<boolean>;
+    auto nvim_buf_set_name(integer buffer, string name) -> Result<void>;
+    auto nvim_buf_set_option(integer buffer, string name, any value) -> Result<void>;
+    auto nvim_buf_set_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                           std::vector<string> replacement) -> Result<void>;
+    auto nvim_buf_set_var(integer buffer, string name, any value) -> Result<void>;
+    auto nvim_buf_set_virtual_text(integer buffer, integer src_id, integer line, std::vector<any> chunks,
+                                   table<string, any> opts) -> Result<integer>;
+    auto nvim_call_dict_function(any dict, string fn, std::vector<any> args) -> Result<any>;
+    auto nvim_call_function(string fn, std::vector<any> args) -> Result<any>;
+    auto nvim_chan_send(integer chan, string data) -> Result<void>;
+    auto nvim_clear_autocmds(table<string, any> opts) -> Result<void>;
+    auto nvim_cmd(table<string, any> cmd, table<string, any> opts) -> Result<string>;
+    auto nvim_command(string command) -> Result<void>;
+    auto nvim_command_output(string command) -> Result<string>;
+    auto nvim_complete_set(integer index, table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_create_augroup(string name, table<string, any> opts) -> Result<integer>;
+    auto nvim_create_buf(boolean listed, boolean scratch) -> Result<integer>;
+    auto nvim_create_namespace(string name) -> Result<integer>;
+    auto nvim_create_user_command(string name, any command, table<string, any> opts) -> Result<void>;
+    auto nvim_del_augroup_by_id(integer id) -> Result<void>;
+    auto nvim_del_augroup_by_name(string name) -> Result<void>;
+    auto nvim_del_autocmd(integer id) -> Result<void>;
+    auto nvim_del_current_line() -> Result<void>;
+    auto nvim_del_keymap(string mode, string lhs) -> Result<void>;
+    auto nvim_del_mark(string name) -> Result<boolean>;
+    auto nvim_del_user_command(string name) -> Result<void>;
+    auto nvim_del_var(string name) -> Result<void>;
+    auto nvim_echo(std::vector<any> chunks, boolean history, table<string, any> opts) -> Result<void>;
+    auto nvim_err_write(string str) -> Result<void>;
+    auto nvim_err_writeln(string str) -> Result<void>;
+    auto nvim_eval(string expr) -> Result<any>;
+    auto nvim_eval_statusline(string str, table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_exec(string src, boolean output) -> Result<string>;
+    auto nvim_exec2(string src, table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_exec_autocmds(any event, table<string, any> opts) -> Result<void>;
+    auto nvim_feedkeys(string keys, string mode, boolean escape_ks) -> Result<void>;
+    auto nvim_get_all_options_info() -> Result<table<string, any>>;
+    auto nvim_get_autocmds(table<string, any> opts) -> Result<std::vector<any>>;
+    auto nvim_get_chan_info(integer chan) -> Result<table<string, any>>;
+    auto nvim_get_color_by_name(string name) -> Result<integer>;
+    auto nvim_get_color_map() -> Result<table<string, any>>;
+    auto nvim_get_commands(table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_get_context(table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_get_current_buf() -> Result<integer>;
+    auto nvim_get_current_line() -> Result<string>;
+    auto nvim_get_current_tabpage() -> Result<integer>;
+    auto nvim_get_current_win() -> Result<integer>;
+    auto nvim_get_hl(integer ns_id, table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_get_hl_by_id(integer hl_id, boolean rgb) -> Result<table<string, any>>;
+    auto nvim_get_hl_by_name(string name, boolean rgb) -> Result<table<string, any>>;
+    auto nvim_get_hl_id_by_name(string name) -> Result<integer>;
+    auto nvim_get_hl_ns(table<string, any> opts) -> Result<integer>;
+    auto nvim_get_keymap(string mode) -> Result<std::vector<table<string, any>>>;
+    auto nvim_get_mark(string name, table<string, any> opts) -> Result<std::vector<any>>;
+    auto nvim_get_mode() -> Result<table<string, any>>;
+    auto nvim_get_namespaces() -> Result<table<string, any>>;
+    auto nvim_get_option(string name) -> Result<any>;
+    auto nvim_get_option_info(string name) -> Result<table<string, any>>;
+    auto nvim_get_option_info2(string name, table<string, any> opts) -> Result<table<string, any>>;
+    auto nvim_get_option_value(string name, table<string, any> opts) -> Result<any>;
+    auto nvim_get_proc(integer pid) -> Result<any>;
+    auto nvim_get_proc_children(integer pid) -> Result<std::vector<any>>;
+    auto nvim_get_runtime_file(string name, boolean all) -> Result<std::vector<string>>;
+    auto nvim_get_var(string name) -> Result<any>;
+    auto nvim_get_vvar(string name) -> Result<any>;
+    auto nvim_input(string keys) -> Result<integer>;
+    auto nvim_input_mouse(string button, string action, string modifier, integer grid, integer row, integer col)
+        -> Result<void>;
+    auto nvim_list_bufs() -> Result<std::vector<integer>>;
+    auto nvim_list_chans() -> Result<std::vector<any>>;
+    auto nvim_list_runtime_paths() -> Result<std::vector<string>>;
+    auto nvim_list_tabpages() -> Result<std::vector<integer>>;
+    auto nvim_list_uis() -> Result<std::vector<any>>;
+    auto nvim_list_wins() -> Result<std::vector<integer>>;
+    auto nvim_load_context(table<string, any> dict) -> Result<any>;
+    auto nvim_notify(string msg, integer log_level, table<string, any> opts) -> Result<any>;
+    auto nvim_open_term(integer buffer, table<string, any> opts) -> Result<integer>;
+    auto nvim_open_win(integer buffer, boolean enter, table<string, any> config) -> Result<integer>;
+    auto nvim_out_write(string str) -> Result<void>;
+    auto nvim_parse_cmd(string str, table<string, any> opts) -> Result<any>;
+    auto nvim_parse_expression(string expr, string flags, boolean highlight) -> Result<table<string, any>>;
+    auto nvim_paste(string data, boolean crlf, integer phase) -> Result<boolean>;
+    auto nvim_put(std::vector<string> lines, string type, boolean after, boolean follow) -> Result<void>;
+    auto nvim_replace_termcodes(string str, boolean from_part, boolean do_lt, boolean special) -> Result<string>;
+    auto nvim_select_popupmenu_item(integer item, boolean insert, boolean finish, table<string, any> opts)
+        -> Result<void>;
+    auto nvim_set_current_buf(integer buffer) -> Result<void>;
+    auto nvim_set_current_dir(string dir) -> Result<void>;
+    auto nvim_set_current_line(string line) -> Result<void>;
+    auto nvim_set_current_tabpage(integer tabpage) -> Result<void>;
+    auto nvim_set_current_win(integer window) -> Result<void>;
+    auto nvim_set_decoration_provider(integer ns_id, table<string, any> opts) -> Result<void>;
+    auto nvim_set_hl(integer ns_id, string name, table<string, any> val) -> Result<void>;
+    auto nvim_set_hl_ns(integer ns_id) -> Result<void>;
+    auto nvim_set_hl_ns_fast(integer ns_id) -> Result<void>;
+    auto nvim_set_keymap(string mode, string lhs, string rhs, table<string, any> opts) -> Result<void>;
+    auto nvim_set_option(string name, any value) -> Result<void>;
+    auto nvim_set_option_value(string name, any value, table<string, any> opts) -> Result<void>;
+    auto nvim_set_var(string name, any value) -> Result<void>;
+    auto nvim_set_vvar(string name, any value) -> Result<void>;
+    auto nvim_strwidth(string text) -> Result<integer>;
+    auto nvim_tabpage_del_var(integer tabpage, string name) -> Result<void>;
+    auto nvim_tabpage_get_number(integer tabpage) -> Result<integer>;
+    auto nvim_tabpage_get_var(integer tabpage, string name) -> Result<any>;
+    auto nvim_tabpage_get_win(integer tabpage) -> Result<integer>;
+    auto nvim_tabpage_is_valid(integer tabpage) -> Result<boolean>;
+    auto nvim_tabpage_list_wins(integer tabpage) -> Result<std::vector<integer>>;
+    auto nvim_tabpage_set_var(integer tabpage, string name, any value) -> Result<void>;
+    auto nvim_tabpage_set_win(integer tabpage, integer win) -> Result<void>;
+    auto nvim_win_close(integer window, boolean force) -> Result<void>;
+    auto nvim_win_del_var(integer window, string name) -> Result<void>;
+    auto nvim_win_get_buf(integer window) -> Result<integer>;
+    auto nvim_win_get_config(integer window) -> Result<table<string, any>>;
+    auto nvim_win_get_cursor(integer window) -> Result<std::vector<integer>>;
+    auto nvim_win_get_height(integer window) -> Result<integer>;
+    auto nvim_win_get_number(integer window) -> Result<integer>;
+    auto nvim_win_get_option(integer window, string name) -> Result<any>;
+    auto nvim_win_get_position(integer window) -> Result<Point>;
+    auto nvim_win_get_tabpage(integer window) -> Result<integer>;
+    auto nvim_win_get_var(integer window, string name) -> Result<any>;
+    auto nvim_win_get_width(integer window) -> Result<integer>;
+    auto nvim_win_hide(integer window) -> Result<void>;
+    auto nvim_win_is_valid(integer window) -> Result<boolean>;
+    auto nvim_win_set_buf(integer window, integer buffer) -> Result<void>;
+    auto nvim_win_set_config(integer window, table<string, any> config) -> Result<void>;
+    auto nvim_win_set_cursor(integer window, std::vector<integer> pos) -> Result<void>;
+    auto nvim_win_set_height(integer window, integer height) -> Result<void>;
+    auto nvim_win_set_hl_ns(integer window, integer ns_id) -> Result<void>;
+    auto nvim_win_set_option(integer window, string name, any value) -> Result<void>;
+    auto nvim_win_set_var(integer window, string name, any value) -> Result<void>;
+    auto nvim_win_set_width(integer window, integer width) -> Result<void>;
+    auto nvim_win_text_height(integer window, table<string, any> opts) -> Result<table<string, any>>;
 };
+
 } // namespace nvim
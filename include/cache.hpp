@@ -0,0 +1,113 @@
+#pragma once
+
+#include "object.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+struct CacheStats {
+    std::size_t hits{};
+    std::size_t misses{};
+    std::size_t invalidations{}; // entries dropped by events
+    std::size_t size{};
+
+    auto hit_rate() const -> double {
+        return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0;
+    }
+};
+
+// Results of calls which only change on known editor events, keyed by method and packed arguments.
+// The owner forwards the events, an event drops the entries of every method which declared it.
+// A result which was requested before an event and arrived after it is not stored, it may predate the change.
+class StateCache {
+    struct Hash : std::hash<std::string_view> {
+        using is_transparent = void;
+    };
+
+    struct Entry {
+        std::string method;
+        ObjectView value;
+    };
+
+    std::map<std::string, std::set<std::string>, std::less<>> methods_; // event -> methods it invalidates
+    std::set<std::string, std::less<>> cached_;
+    std::unordered_map<std::string, Entry, Hash, std::equal_to<>> entries_;
+    std::uint64_t epoch_{};
+    CacheStats stats_;
+
+public:
+    // events which invalidate the results of each method
+    explicit StateCache(const std::map<std::string, std::vector<std::string>, std::less<>>& policy) {
+        for (const auto& [method, events] : policy) {
+            cached_.insert(method);
+            for (const auto& event : events) {
+                methods_[event].insert(method);
+            }
+        }
+    }
+
+    auto caches(std::string_view method) const -> bool {
+        return cached_.contains(method);
+    }
+
+    auto find(std::string_view key) -> std::optional<ObjectView> {
+        const auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+
+        ++stats_.hits;
+        return it->second.value;
+    }
+
+    // changes with every event, taken before the call and passed to `insert()` with its result
+    auto epoch() const -> std::uint64_t {
+        return epoch_;
+    }
+
+    auto insert(std::string key, std::string_view method, ObjectView value, std::uint64_t epoch) -> void {
+        if (epoch == epoch_)
+            entries_.insert_or_assign(std::move(key), Entry{std::string{method}, std::move(value)});
+    }
+
+    auto invalidate(std::string_view event) -> void {
+        ++epoch_;
+
+        const auto it = methods_.find(event);
+        if (it == methods_.end())
+            return;
+
+        stats_.invalidations += std::erase_if(entries_, [&methods = it->second](const auto& entry) {
+            return methods.contains(entry.second.method);
+        });
+    }
+
+    // every event the policy declares
+    auto events() const -> std::vector<std::string> {
+        std::vector<std::string> events;
+        for (const auto& [event, _] : methods_) {
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    auto stats() const -> CacheStats {
+        auto stats = stats_;
+        stats.size = entries_.size();
+        return stats;
+    }
+};
+
+} // namespace rpc
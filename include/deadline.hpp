@@ -0,0 +1,161 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+// Deadlines of all in-flight calls on a single timer. Time is split into ticks and a deadline goes to the bucket
+// of its tick, so arming a deadline is a push_back. A call which completes removes its entry from that bucket,
+// so an expiry never refers to a request that is gone. The timer runs only while there are entries.
+class TimerWheel {
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::uint64_t tick{};
+        std::uint32_t id{};
+    };
+
+    const std::chrono::milliseconds resolution_;
+    const Clock::time_point start_{Clock::now()};
+    std::vector<std::vector<Entry>> buckets_;
+    std::vector<std::uint32_t> expired_;
+    std::uint64_t tick_{}; // next tick to process
+    std::size_t size_{};
+    std::function<void(std::uint32_t)> expire_;
+    std::optional<boost::asio::steady_timer> timer_;
+    bool running_{};
+
+    auto current_tick() const -> std::uint64_t {
+        return static_cast<std::uint64_t>((Clock::now() - start_) / resolution_);
+    }
+
+    auto arm() -> void {
+        timer_->expires_after(resolution_);
+        timer_->async_wait([this](const boost::system::error_code& e) {
+            // cancelled when the wheel is destroyed, don't touch it then
+            if (!e)
+                advance();
+        });
+    }
+
+    auto advance() -> void {
+        const auto now = current_tick();
+
+        // after a long stall every bucket is visited once, deadlines are compared with the current tick anyway
+        const auto last = std::min<std::uint64_t>(now, tick_ + buckets_.size() - 1);
+        for (auto tick = tick_; tick <= last; ++tick) {
+            auto& bucket = buckets_[tick % buckets_.size()];
+            std::erase_if(bucket, [this, now](const Entry& entry) {
+                if (entry.tick > now)
+                    return false;
+
+                expired_.push_back(entry.id);
+                return true;
+            });
+        }
+        tick_ = now + 1;
+        size_ -= expired_.size();
+
+        for (const auto id : expired_) {
+            expire_(id);
+        }
+        expired_.clear();
+
+        running_ = size_ != 0;
+        if (running_)
+            arm();
+    }
+
+public:
+    explicit TimerWheel(std::function<void(std::uint32_t)> expire,
+                        std::chrono::milliseconds resolution = std::chrono::milliseconds{10}, std::size_t buckets = 512)
+        : resolution_{resolution}
+        , buckets_(buckets)
+        , expire_{std::move(expire)} {}
+
+    TimerWheel(const TimerWheel&) = delete;
+    auto operator=(const TimerWheel&) -> TimerWheel& = delete;
+
+    // Calls the expiry callback with the id once the timeout has passed, rounded up to the resolution.
+    // Returns the tick of the deadline for `remove()`.
+    auto add(const boost::asio::any_io_executor& ex, std::uint32_t id, std::chrono::milliseconds timeout)
+        -> std::uint64_t {
+        if (!timer_)
+            timer_.emplace(ex);
+
+        if (!running_) {
+            tick_ = current_tick();
+        }
+
+        const auto ticks = (timeout.count() + resolution_.count() - 1) / resolution_.count();
+        const auto tick = current_tick() + std::max<std::uint64_t>(1, ticks);
+        buckets_[tick % buckets_.size()].push_back(Entry{.tick = tick, .id = id});
+        ++size_;
+
+        if (!running_) {
+            running_ = true;
+            arm();
+        }
+        return tick;
+    }
+
+    // drops the deadline if it has not expired yet
+    auto remove(std::uint32_t id, std::uint64_t tick) -> void {
+        auto& bucket = buckets_[tick % buckets_.size()];
+        const auto it = std::find_if(bucket.begin(), bucket.end(), [id, tick](const Entry& entry) {
+            return entry.id == id && entry.tick == tick;
+        });
+        if (it == bucket.end())
+            return;
+
+        *it = bucket.back();
+        bucket.pop_back();
+        --size_;
+    }
+
+    auto size() const -> std::size_t {
+        return size_;
+    }
+};
+
+// Abandons the calls made with it, e.g. when the buffer they were made for is gone.
+// Their slots are released and the waiting coroutines get `CancelledError`, responses arriving later are dropped.
+class Cancellation {
+    std::map<std::uint64_t, std::function<void()>> pending_;
+    std::uint64_t next_{};
+    bool cancelled_{};
+
+public:
+    auto cancel() -> void {
+        cancelled_ = true;
+        for (auto& [_, abandon] : std::exchange(pending_, {})) {
+            abandon();
+        }
+    }
+
+    auto is_cancelled() const -> bool {
+        return cancelled_;
+    }
+
+    // used by the client for every call in flight, returns a token for `unbind()`
+    auto bind(std::function<void()> abandon) -> std::uint64_t {
+        pending_.emplace(next_, std::move(abandon));
+        return next_++;
+    }
+
+    auto unbind(std::uint64_t token) -> void {
+        pending_.erase(token);
+    }
+};
+
+} // namespace rpc
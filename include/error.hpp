@@ -0,0 +1,55 @@
+#pragma once
+
+#include <expected>
+#include <stdexcept>
+#include <string>
+
+namespace rpc {
+
+// Why a call failed, the first two are the error types Neovim sends
+enum class ErrorType {
+    Exception = 0,
+    Validation = 1,
+    Timeout,
+    Cancelled,
+};
+
+struct Error {
+    ErrorType type{};
+    std::string message;
+};
+
+// Outcome of a call which doesn't throw, see `Client::try_call`
+template <typename T>
+using Result = std::expected<T, Error>;
+
+// error response of Neovim
+struct CallError : std::runtime_error {
+    ErrorType type{};
+
+    CallError(ErrorType type, const std::string& message)
+        : std::runtime_error{message}
+        , type{type} {}
+};
+
+struct TimeoutError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+struct CancelledError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// the exception thrown for the error by the throwing calls
+[[noreturn]] inline auto raise(const Error& error) -> void {
+    switch (error.type) {
+    case ErrorType::Timeout:
+        throw TimeoutError(error.message);
+    case ErrorType::Cancelled:
+        throw CancelledError(error.message);
+    default:
+        throw CallError(error.type, error.message);
+    }
+}
+
+} // namespace rpc
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <coroutine>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+// Calls in flight by key, so a call identical to one in flight can wait for its result instead of being sent.
+// The first call of a key is the leader, it lands the flight with its result and every waiter gets a copy.
+template <typename T>
+class SingleFlight {
+    struct Flight {
+        std::optional<T> result;
+        std::vector<std::coroutine_handle<>> waiters;
+    };
+
+    struct Hash : std::hash<std::string_view> {
+        using is_transparent = void;
+    };
+
+    std::unordered_map<std::string, std::shared_ptr<Flight>, Hash, std::equal_to<>> flights_;
+
+public:
+    // Waits for the result of a flight, resumed from the event loop when the leader lands
+    class Join {
+        std::shared_ptr<Flight> flight_;
+        std::coroutine_handle<> waiter_;
+
+    public:
+        explicit Join(std::shared_ptr<Flight> flight)
+            : flight_{std::move(flight)} {}
+
+        Join(const Join&) = delete;
+        auto operator=(const Join&) -> Join& = delete;
+
+        ~Join() {
+            if (waiter_) {
+                std::erase(flight_->waiters, waiter_);
+            }
+        }
+
+        auto await_ready() const -> bool {
+            return flight_->result.has_value();
+        }
+
+        auto await_suspend(std::coroutine_handle<> waiter) -> void {
+            waiter_ = waiter;
+            flight_->waiters.push_back(waiter);
+        }
+
+        auto await_resume() -> T {
+            waiter_ = nullptr;
+            return *flight_->result;
+        }
+    };
+
+    // joins the flight of the key, empty if there is none
+    auto join(std::string_view key) -> std::optional<Join> {
+        const auto it = flights_.find(key);
+        if (it == flights_.end())
+            return std::nullopt;
+        return std::optional<Join>{std::in_place, it->second};
+    }
+
+    auto start(std::string key) -> void {
+        flights_.emplace(std::move(key), std::make_shared<Flight>());
+    }
+
+    // ends the flight of the key if it's still in the air, the waiters are resumed from the event loop
+    auto land(std::string_view key, T result, const boost::asio::any_io_executor& ex) -> void {
+        const auto it = flights_.find(key);
+        if (it == flights_.end())
+            return;
+
+        auto flight = std::move(it->second);
+        flights_.erase(it);
+
+        flight->result.emplace(std::move(result));
+        for (const auto waiter : flight->waiters) {
+            boost::asio::post(ex, [flight, waiter] {
+                // a waiter which was destroyed meanwhile has removed itself
+                if (std::find(flight->waiters.begin(), flight->waiters.end(), waiter) != flight->waiters.end())
+                    waiter.resume();
+            });
+        }
+    }
+
+    auto size() const -> std::size_t {
+        return flights_.size();
+    }
+};
+
+} // namespace rpc
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace rpc {
+
+// Counters of the inbound side of a connection
+struct ReceiveStats {
+    std::size_t messages{};
+    std::size_t bytes{};
+    std::size_t buffer_allocations{}; // the read buffer was resized
+    std::size_t zone_allocations{};   // new zones for decoded messages, stays flat once the pool is warm
+    std::size_t zone_growths{};       // messages which didn't fit the first chunk of their zone, one or more chunks
+    std::size_t capacity{};
+
+    // counts a grown zone as a single allocation, so large messages are a lower bound
+    auto allocations_per_mb() const -> double {
+        return bytes ? (buffer_allocations + zone_allocations + zone_growths) * 1024.0 * 1024.0 / bytes : 0;
+    }
+};
+
+// Finds where a msgpack message ends without decoding it. When the message is not complete yet, the next scan
+// resumes where the previous one stopped, so a large message arriving in many reads is scanned once.
+class FrameScanner {
+    std::size_t offset_{};      // scanned bytes of the current message
+    std::uint64_t objects_{1};  // objects left to scan in the current message
+    std::size_t needed_{};      // the current message is at least that long
+
+public:
+    // Size of the message at the start of data once it's complete.
+    // The data must start with the same message until then, it may only grow.
+    auto scan(const char* data, std::size_t size) -> std::optional<std::size_t> {
+        const auto* p = reinterpret_cast<const unsigned char*>(data);
+
+        while (objects_) {
+            if (offset_ >= size) {
+                needed_ = offset_ + 1;
+                return std::nullopt;
+            }
+
+            enum class Kind { Scalar, Payload, Array, Map };
+
+            const auto b = p[offset_];
+            auto kind = Kind::Scalar;
+            std::uint64_t fixed = 0;  // bytes after the header
+            std::size_t length = 0;   // bytes of the length field in the header
+            std::uint64_t children = 0;
+
+            if (b <= 0x7f || b >= 0xe0) {
+                // positive and negative fixint
+            } else if (b <= 0x8f) {
+                children = 2 * (b & 0x0f);
+            } else if (b <= 0x9f) {
+                children = b & 0x0f;
+            } else if (b <= 0xbf) {
+                fixed = b & 0x1f;
+            } else {
+                switch (b) {
+                case 0xc0: // nil, false, true
+                case 0xc2:
+                case 0xc3:
+                    break;
+                case 0xcc:
+                case 0xd0:
+                    fixed = 1;
+                    break;
+                case 0xcd:
+                case 0xd1:
+                    fixed = 2;
+                    break;
+                case 0xca:
+                case 0xce:
+                case 0xd2:
+                    fixed = 4;
+                    break;
+                case 0xcb:
+                case 0xcf:
+                case 0xd3:
+                    fixed = 8;
+                    break;
+                case 0xd4: // fixext, type byte and 1 to 16 bytes of data
+                case 0xd5:
+                case 0xd6:
+                case 0xd7:
+                case 0xd8:
+                    fixed = 1 + (1u << (b - 0xd4));
+                    break;
+                case 0xc4: // bin and str
+                case 0xd9:
+                    kind = Kind::Payload;
+                    length = 1;
+                    break;
+                case 0xc5:
+                case 0xda:
+                    kind = Kind::Payload;
+                    length = 2;
+                    break;
+                case 0xc6:
+                case 0xdb:
+                    kind = Kind::Payload;
+                    length = 4;
+                    break;
+                case 0xc7: // ext, the type byte follows the length
+                case 0xc8:
+                case 0xc9:
+                    kind = Kind::Payload;
+                    length = std::size_t{1} << (b - 0xc7);
+                    fixed = 1;
+                    break;
+                case 0xdc:
+                case 0xdd:
+                    kind = Kind::Array;
+                    length = b == 0xdc ? 2 : 4;
+                    break;
+                case 0xde:
+                case 0xdf:
+                    kind = Kind::Map;
+                    length = b == 0xde ? 2 : 4;
+                    break;
+                default:
+                    throw std::runtime_error("Invalid msgpack type byte 0xc1");
+                }
+            }
+
+            if (offset_ + 1 + length > size) {
+                needed_ = offset_ + 1 + length;
+                return std::nullopt;
+            }
+
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < length; ++i) {
+                value = (value << 8) | p[offset_ + 1 + i];
+            }
+
+            if (kind == Kind::Payload)
+                fixed += value;
+            else if (kind == Kind::Array)
+                children += value;
+            else if (kind == Kind::Map)
+                children += 2 * value;
+
+            const auto total = 1 + length + fixed;
+            if (offset_ + total > size) {
+                needed_ = offset_ + total;
+                return std::nullopt;
+            }
+
+            offset_ += total;
+            objects_ += children;
+            --objects_;
+        }
+
+        const auto message = offset_;
+        offset_ = 0;
+        objects_ = 1;
+        needed_ = 0;
+        return message;
+    }
+
+    // bytes the message being scanned needs at least, zero between messages
+    auto needed() const -> std::size_t {
+        return needed_;
+    }
+};
+
+// Read buffer of a connection which yields complete messages. It grows straight to the size a partial message
+// is known to need instead of doubling towards it, and shrinks back once no large message came for a while.
+class ReceiveBuffer {
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t initial_size = 64 * 1024;
+    static constexpr std::size_t min_read = 4 * 1024;
+    static constexpr auto idle = std::chrono::seconds{10};
+
+    std::unique_ptr<char[]> data_;
+    std::size_t capacity_{};
+    std::size_t begin_{}; // first byte of the message being received
+    std::size_t end_{};   // end of the received bytes
+    FrameScanner scanner_;
+    Clock::time_point last_large_{};
+    ReceiveStats stats_;
+
+    auto reallocate(std::size_t capacity) -> void {
+        auto data = std::make_unique_for_overwrite<char[]>(capacity);
+        if (end_ > begin_)
+            std::memcpy(data.get(), data_.get() + begin_, end_ - begin_);
+
+        end_ -= begin_;
+        begin_ = 0;
+        data_ = std::move(data);
+        capacity_ = capacity;
+        ++stats_.buffer_allocations;
+    }
+
+public:
+    ReceiveBuffer() {
+        reallocate(initial_size);
+    }
+
+    // space for the next read, big enough for the rest of a partially received message
+    auto prepare() -> boost::asio::mutable_buffer {
+        const auto pending = end_ - begin_;
+        if (!pending && capacity_ > initial_size && Clock::now() - last_large_ > idle)
+            reallocate(initial_size);
+
+        const auto required = std::max(scanner_.needed(), pending + min_read);
+        if (capacity_ < required) {
+            reallocate(std::bit_ceil(required));
+            last_large_ = Clock::now();
+        } else if (capacity_ - begin_ < required) {
+            std::memmove(data_.get(), data_.get() + begin_, pending);
+            begin_ = 0;
+            end_ = pending;
+        }
+        return boost::asio::buffer(data_.get() + end_, capacity_ - end_);
+    }
+
+    auto commit(std::size_t n) -> void {
+        end_ += n;
+        stats_.bytes += n;
+    }
+
+    // next complete message, the view is valid until the next `prepare()`
+    auto next() -> std::optional<std::string_view> {
+        const auto size = scanner_.scan(data_.get() + begin_, end_ - begin_);
+        if (!size)
+            return std::nullopt;
+
+        const auto message = std::string_view{data_.get() + begin_, *size};
+        begin_ += *size;
+        if (begin_ == end_)
+            begin_ = end_ = 0;
+
+        if (*size > initial_size)
+            last_large_ = Clock::now();
+        ++stats_.messages;
+        return message;
+    }
+
+    auto stats() const -> ReceiveStats {
+        auto stats = stats_;
+        stats.capacity = capacity_;
+        return stats;
+    }
+};
+
+} // namespace rpc
@@ -4,42 +4,85 @@
 
 #include <boost/cobalt/promise.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <string>
+#include <string_view>
 
 namespace nvim {
 class Api;
 
+// What the terminal reported to the probe, unknown sizes are zero
+struct TerminalCaps {
+    Size screen{};              // text area in pixels, CSI 14 t
+    Size cell{};                // cell in pixels, CSI 16 t
+    bool kitty{};               // kitty graphics with the data in the escape sequence
+    bool kitty_files{};         // kitty graphics reading the data from a temporary file, the terminal is on this host
+    bool synchronized_update{}; // mode 2026, the screen is updated once the placements are done
+
+    // the replies up to and including the DA1 one, which every terminal answers last
+    static auto parse(std::string_view replies) -> TerminalCaps;
+};
+
 class Graphics {
     Api& api_;
     const int retry_count_{};
+    std::chrono::milliseconds query_timeout_{500};
 
     std::string tty_;
     std::ofstream ofs_;
+    TerminalCaps caps_{};
     Size screen_size_{};
     Size terminal_size_{};
     Size cell_size_{};
 
-    auto run_lua_io(std::string_view data) -> boost::cobalt::promise<std::string>;
+    // screen cells of windows without the offsets of their text, valid until the layout changes
+    std::map<int, Point> positions_;
+    std::uint64_t layout_{};
+
+    std::map<int, std::string> ttys_; // by Neovim pid
+
+    // writes the escape sequences to the terminal, reply is the Lua pattern of its answer
+    auto query(std::string_view data, std::string_view reply) -> boost::cobalt::promise<std::string>;
+
+    // asks the terminal where the cursor is with it moved to the first line, slow and visible
+    auto cursor_position(int win_id) -> boost::cobalt::promise<Point>;
+
+    // pipelines every query of `TerminalCaps` in one write and parses all replies of one read
+    auto probe() -> boost::cobalt::promise<TerminalCaps>;
 
 public:
-    Graphics(Api& api, int retry_count = 5);
+    // tty is looked up from the Neovim process unless given, e.g. /dev/null for replays
+    Graphics(Api& api, int retry_count = 5, std::string tty = {});
 
     auto api() -> Api&;
 
+    // How long a terminal query waits for the reply before it's retried, only slow when the terminal doesn't answer
+    auto set_query_timeout(std::chrono::milliseconds timeout) -> void;
+
     auto init() -> boost::cobalt::promise<void>;
+
+    // probes the terminal again, e.g. after a resize
     auto update() -> boost::cobalt::promise<void>;
 
+    // drops the window positions whenever the layout changes and updates the sizes on every VimResized
+    auto handle_layout(int augroup) -> boost::cobalt::promise<void>;
+
+    auto caps() const -> const TerminalCaps&;
+
     // returns height and width
-    auto screen_size() -> boost::cobalt::promise<Size>;
+    auto screen_size() -> Size;
     auto terminal_size() -> Size;
     auto cell_size() -> Size;
 
-    // returns first and last visible lines
-    auto visible_area() -> boost::cobalt::promise<std::pair<int, int>>;
+    // returns first and last visible lines of the window
+    auto visible_area(int win_id) -> boost::cobalt::promise<std::pair<int, int>>;
 
-    // returns row and col
+    // returns row and col, computed by Neovim, the terminal is only asked if that fails
     auto position(int win_id) -> boost::cobalt::promise<Point>;
 
+    // controlling terminal of Neovim or the closest of its parents, read from /proc without running anything
     auto get_tty() -> boost::cobalt::promise<std::string>;
 
     auto stream() -> std::ostream&;
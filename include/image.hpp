@@ -76,8 +76,14 @@ template <typename Backend>
 auto Image<Backend>::update_line() -> boost::cobalt::promise<void> {
     static const int ns_id = co_await graphics_.api().nvim_create_namespace("jupyter");
     if (mark_id_) {
-        const auto mark = co_await graphics_.api().nvim_buf_get_extmark_by_id(0, ns_id, mark_id_, {});
-        const auto& val = mark.as_vector();
+        // the mark is gone if the buffer was wiped, the last known line is kept then
+        const auto mark = co_await graphics_.api().try_nvim_buf_get_extmark_by_id(0, ns_id, mark_id_, {});
+        if (!mark) {
+            spdlog::debug("Failed to get mark {}: {}", mark_id_, mark.error().message);
+            co_return;
+        }
+
+        const auto& val = mark->as_vector();
         if (!val.empty()) {
             buf_line_ = val.at(0).as_uint64_t();
         }
@@ -107,16 +113,17 @@ auto Image<Backend>::place(int virt_offset, int buf, int win_id) -> boost::cobal
 
     if (!mark_id_) {
         // fill area with virtual text
-        using any = nvim::Api::any;
-        std::vector<any> virt_lines(area.h, std::vector<any>{{std::vector<any>{{"", "Comment"}}}});
-
-        mark_id_ = co_await graphics_.api().nvim_buf_set_extmark(buf, ns_id, buf_line_, 0,
-                                                                 {{"virt_lines", std::move(virt_lines)}});
+        const auto lines = nvim::VirtLines{.chunks = {{"", "Comment"}}, .count = static_cast<std::size_t>(area.h)};
+        auto opts = nvim::ExtmarkOpts{.virt_lines = lines};
+        mark_id_ = co_await graphics_.api().nvim_buf_set_extmark(buf, ns_id, buf_line_, 0, std::move(opts));
 
         spdlog::info("Aligning image at line {} size {} with mark {}, window: {}", buf_line_, area, mark_id_, win_id);
     } else if (mark_id_ && !visible_[win_id]) {
         spdlog::info("Hiding image at line {} size {} with mark {}, window: {}", buf_line_, area, mark_id_, win_id);
-        co_await graphics_.api().nvim_buf_del_extmark(buf, ns_id, mark_id_);
+        // the mark may have been removed with its buffer or by the stale mark cleanup
+        if (const auto deleted = co_await graphics_.api().try_nvim_buf_del_extmark(buf, ns_id, mark_id_); !deleted) {
+            spdlog::debug("Failed to delete mark {}: {}", mark_id_, deleted.error().message);
+        }
         mark_id_ = 0;
     }
 
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+// Latency histogram in the spirit of HdrHistogram. Values are grouped by their power of two and every power of two
+// is split into 16 linear sub-buckets, so any percentile is off by less than 1/16 of its value.
+// Recording is an increment, the memory is fixed.
+class Histogram {
+    static constexpr std::uint32_t sub_bits = 4;
+    static constexpr std::uint32_t sub_buckets = 1u << sub_bits;
+    static constexpr std::uint64_t max_value = (std::uint64_t{1} << 32) - 1;
+
+    std::array<std::uint64_t, (32 - sub_bits + 1) * sub_buckets> counts_{};
+    std::uint64_t count_{};
+    std::uint64_t sum_{};
+    std::uint64_t max_{};
+
+    static auto index(std::uint64_t value) -> std::size_t {
+        if (value < sub_buckets)
+            return value;
+
+        // the top sub_bits + 1 bits select the bucket
+        const auto shift = std::bit_width(value) - 1 - sub_bits;
+        return (shift + 1) * sub_buckets + ((value >> shift) - sub_buckets);
+    }
+
+    static auto lowest(std::size_t index) -> std::uint64_t {
+        if (index < sub_buckets)
+            return index;
+
+        const auto shift = index / sub_buckets - 1;
+        return (sub_buckets + index % sub_buckets) << shift;
+    }
+
+public:
+    auto record(std::uint64_t value) -> void {
+        value = std::min(value, max_value);
+        ++counts_[index(value)];
+        ++count_;
+        sum_ += value;
+        max_ = std::max(max_, value);
+    }
+
+    // highest value of the bucket the percentile falls into, p is in [0, 1]
+    auto percentile(double p) const -> std::uint64_t {
+        const auto target = static_cast<std::uint64_t>(std::ceil(p * count_));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target && counts_[i])
+                return std::min(max_, i + 1 < counts_.size() ? lowest(i + 1) - 1 : max_value);
+        }
+        return max_;
+    }
+
+    auto count() const -> std::uint64_t {
+        return count_;
+    }
+
+    auto mean() const -> double {
+        return count_ ? static_cast<double>(sum_) / count_ : 0;
+    }
+
+    auto max() const -> std::uint64_t {
+        return max_;
+    }
+};
+
+// Counters of one method, latency is from queueing the request to receiving the response, in microseconds
+struct MethodStats {
+    std::size_t calls{};
+    std::size_t shared{}; // answered with the response of an identical call in flight, see `SingleFlight`
+    std::size_t cached{}; // answered from the `StateCache`
+    std::size_t errors{}; // error responses, timeouts and cancellations
+    std::size_t timeouts{};
+    std::size_t bytes_out{};
+    std::size_t bytes_in{};
+    std::size_t in_flight{};
+    Histogram latency;
+};
+
+class Metrics {
+    std::map<std::string, MethodStats, std::less<>> methods_;
+
+public:
+    auto method(std::string_view name) -> MethodStats& {
+        if (const auto it = methods_.find(name); it != methods_.end())
+            return it->second;
+        return methods_.emplace(std::string{name}, MethodStats{}).first->second;
+    }
+
+    auto methods() const -> const std::map<std::string, MethodStats, std::less<>>& {
+        return methods_;
+    }
+
+    // table of all methods, slowest p99 first
+    auto report() const -> std::string {
+        std::vector<const std::pair<const std::string, MethodStats>*> rows;
+        for (const auto& row : methods_) {
+            rows.push_back(&row);
+        }
+        std::sort(rows.begin(), rows.end(), [](const auto* a, const auto* b) {
+            return a->second.latency.percentile(0.99) > b->second.latency.percentile(0.99);
+        });
+
+        auto out = fmt::format("{:<32} {:>8} {:>6} {:>6} {:>6} {:>6} {:>10} {:>10} {:>8} {:>8} {:>8} {:>8}\n",
+                               "method", "calls", "cached", "shared", "errors", "flight", "bytes out", "bytes in",
+                               "p50 us", "p90 us", "p99 us", "max us");
+        for (const auto* row : rows) {
+            const auto& [name, stats] = *row;
+            out += fmt::format("{:<32} {:>8} {:>6} {:>6} {:>6} {:>6} {:>10} {:>10} {:>8} {:>8} {:>8} {:>8}\n", name,
+                               stats.calls, stats.cached, stats.shared, stats.errors, stats.in_flight, stats.bytes_out,
+                               stats.bytes_in, stats.latency.percentile(0.5), stats.latency.percentile(0.9),
+                               stats.latency.percentile(0.99), stats.latency.max());
+        }
+        return out;
+    }
+};
+
+} // namespace rpc
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <msgpack.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace rpc {
+
+// View of a part of a received message, shares the zone of the whole message so nothing is copied.
+// Deep copies happen only when the caller asks for an owned type with `as<T>()`.
+class ObjectView {
+    std::shared_ptr<const msgpack::zone> zone_;
+    msgpack::object object_;
+
+public:
+    ObjectView() = default;
+
+    ObjectView(std::shared_ptr<const msgpack::zone> zone, const msgpack::object& object)
+        : zone_{std::move(zone)}
+        , object_{object} {}
+
+    auto get() const -> const msgpack::object& {
+        return object_;
+    }
+
+    auto is_nil() const -> bool {
+        return object_.is_nil();
+    }
+
+    // number of elements of an array or key-value pairs of a map
+    auto size() const -> std::size_t {
+        switch (object_.type) {
+        case msgpack::type::ARRAY:
+            return object_.via.array.size;
+        case msgpack::type::MAP:
+            return object_.via.map.size;
+        default:
+            throw msgpack::type_error();
+        }
+    }
+
+    // array element
+    auto operator[](std::size_t index) const -> ObjectView {
+        if (object_.type != msgpack::type::ARRAY) {
+            throw msgpack::type_error();
+        }
+        if (index >= object_.via.array.size) {
+            throw std::out_of_range("array index is out of range");
+        }
+        return ObjectView{zone_, object_.via.array.ptr[index]};
+    }
+
+    // map value by a string key
+    auto find(std::string_view key) const -> std::optional<ObjectView> {
+        if (object_.type != msgpack::type::MAP) {
+            throw msgpack::type_error();
+        }
+        for (const auto& kv : std::span(object_.via.map.ptr, object_.via.map.size)) {
+            if (kv.key.type == msgpack::type::STR && std::string_view{kv.key.via.str.ptr, kv.key.via.str.size} == key) {
+                return ObjectView{zone_, kv.val};
+            }
+        }
+        return std::nullopt;
+    }
+
+    // string or binary data, valid as long as any view of the message exists
+    auto str() const -> std::string_view {
+        switch (object_.type) {
+        case msgpack::type::STR:
+            return {object_.via.str.ptr, object_.via.str.size};
+        case msgpack::type::BIN:
+            return {object_.via.bin.ptr, object_.via.bin.size};
+        default:
+            throw msgpack::type_error();
+        }
+    }
+
+    template <typename T>
+    auto as() const -> T {
+        return object_.as<T>();
+    }
+};
+
+// Buffer, window or tabpage id. Neovim sends them as EXT objects with a msgpack integer inside,
+// plain integers are accepted as well.
+struct Handle {
+    int id{};
+
+    operator int() const {
+        return id;
+    }
+};
+
+} // namespace rpc
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
+    namespace adaptor {
+
+    template <>
+    struct convert<rpc::Handle> {
+        auto operator()(const msgpack::object& o, rpc::Handle& v) const -> const msgpack::object& {
+            if (o.type != msgpack::type::EXT) {
+                v.id = o.as<int>();
+                return o;
+            }
+
+            // handles are small positive integers, decode the common encodings without a zone
+            const auto data = reinterpret_cast<const unsigned char*>(o.via.ext.data());
+            const auto size = o.via.ext.size;
+            if (size == 1 && data[0] < 0x80) {
+                v.id = data[0];
+            } else if (size == 2 && data[0] == 0xcc) {
+                v.id = data[1];
+            } else if (size == 3 && data[0] == 0xcd) {
+                v.id = (data[1] << 8) | data[2];
+            } else {
+                v.id = msgpack::unpack(o.via.ext.data(), size)->as<int>();
+            }
+            return o;
+        }
+    };
+
+    } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "pack.hpp"
+
+#include <msgpack.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nvim {
+
+// Piece of virtual text, [text, highlight group]
+struct Chunk {
+    std::string text;
+    std::string hl_group;
+
+    template <typename Packer>
+    auto msgpack_pack(Packer& pk) const -> void {
+        pk.pack_array(2);
+        pk.pack(text);
+        pk.pack(hl_group);
+    }
+};
+
+// `count` copies of one virtual line, e.g. blank lines which reserve space for an image.
+// The line is packed once and its bytes are copied for the rest.
+struct VirtLines {
+    std::vector<Chunk> chunks;
+    std::size_t count{};
+
+    template <typename Packer>
+    auto msgpack_pack(Packer& pk) const -> void {
+        struct Line {
+            std::string data;
+
+            auto write(const char* buf, std::size_t len) -> void {
+                data.append(buf, len);
+            }
+        } line;
+
+        msgpack::pack(line, chunks);
+
+        pk.pack_array(static_cast<std::uint32_t>(count));
+        for (std::size_t i = 0; i < count; ++i) {
+            pk.pack_bin_body(line.data.data(), line.data.size());
+        }
+    }
+};
+
+// `opts` of `nvim_buf_set_extmark()`, only the fields which are set are sent
+struct ExtmarkOpts {
+    std::optional<int> id;
+    std::optional<int> end_row;
+    std::optional<int> end_col;
+    std::optional<std::string> hl_group;
+    std::optional<std::vector<Chunk>> virt_text;
+    std::optional<std::string> virt_text_pos;
+    std::optional<VirtLines> virt_lines;
+    std::optional<bool> virt_lines_above;
+    std::optional<bool> right_gravity;
+    std::optional<int> priority;
+
+    template <typename Packer>
+    auto msgpack_pack(Packer& pk) const -> void {
+        rpc::pack_fields(pk, rpc::field("id", id), rpc::field("end_row", end_row), rpc::field("end_col", end_col),
+                         rpc::field("hl_group", hl_group), rpc::field("virt_text", virt_text),
+                         rpc::field("virt_text_pos", virt_text_pos), rpc::field("virt_lines", virt_lines),
+                         rpc::field("virt_lines_above", virt_lines_above), rpc::field("right_gravity", right_gravity),
+                         rpc::field("priority", priority));
+    }
+};
+
+// `opts` of `nvim_create_autocmd()` without the callback, it's set by the Api to notify the client
+struct AutocmdOpts {
+    std::optional<int> group;
+    std::optional<std::vector<std::string>> pattern;
+    std::optional<int> buffer;
+    std::optional<std::string> desc;
+    std::optional<bool> once;
+    std::optional<bool> nested;
+
+    template <typename Packer>
+    auto msgpack_pack(Packer& pk) const -> void {
+        rpc::pack_fields(pk, rpc::field("group", group), rpc::field("pattern", pattern), rpc::field("buffer", buffer),
+                         rpc::field("desc", desc), rpc::field("once", once), rpc::field("nested", nested));
+    }
+};
+
+// Filters applied in Neovim before an autocmd event is sent to the client.
+// Debounce and throttle apply per event, buffer and file, so a burst in one buffer doesn't hide another one.
+struct EventFilter {
+    std::optional<std::string> buffers;             // name of a buffer allowlist, see `Api::allow_buffer()`
+    std::optional<std::vector<std::string>> fields; // fields of `ev` to send, all of them if unset
+    std::optional<int> debounce;                    // ms, a burst of events sends its last one after it's over
+    std::optional<int> throttle;                    // ms, at most one event per interval, the last one is sent late
+
+    template <typename Packer>
+    auto msgpack_pack(Packer& pk) const -> void {
+        rpc::pack_fields(pk, rpc::field("buffers", buffers), rpc::field("fields", fields),
+                         rpc::field("debounce", debounce), rpc::field("throttle", throttle));
+    }
+};
+
+// `opts` of `nvim_exec2()`
+struct Exec2Opts {
+    std::optional<bool> output;
+
+    template <typename Packer>
+    auto msgpack_pack(Packer& pk) const -> void {
+        rpc::pack_fields(pk, rpc::field("output", output));
+    }
+};
+
+// Result of `Api::visible_lines()`
+struct VisibleLines {
+    int first{};
+    int last{};
+
+    MSGPACK_DEFINE_MAP(first, last);
+};
+
+// Result of `Api::window_origin()`
+struct WindowOrigin {
+    int row{};
+    int col{};
+    int top{};  // rows above the first text line
+    int left{}; // columns left of the text
+
+    MSGPACK_DEFINE_MAP(row, col, top, left);
+};
+
+// Result of `nvim_exec2()`, output is empty unless it was requested
+struct Exec2Result {
+    std::string output;
+
+    MSGPACK_DEFINE_MAP(output);
+};
+
+} // namespace nvim
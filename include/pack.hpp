@@ -0,0 +1,104 @@
+#pragma once
+
+#include <msgpack.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace rpc {
+
+// String packed as a msgpack str once, method names are copied into requests instead of being packed every time.
+// Literals are packed at compile time.
+class Name {
+public:
+    static constexpr std::size_t capacity = 64;
+
+private:
+    std::array<char, capacity> packed_{};
+    std::size_t header_{};
+    std::size_t size_{};
+
+    constexpr auto init(std::string_view name) -> void {
+        if (name.size() > capacity - 2)
+            throw std::length_error("Name is too long");
+
+        if (name.size() < 32) {
+            packed_[0] = static_cast<char>(0xa0 | name.size()); // fixstr
+            header_ = 1;
+        } else {
+            packed_[0] = static_cast<char>(0xd9); // str 8
+            packed_[1] = static_cast<char>(name.size());
+            header_ = 2;
+        }
+
+        std::copy(name.begin(), name.end(), packed_.begin() + header_);
+        size_ = header_ + name.size();
+    }
+
+public:
+    template <std::size_t N>
+    consteval Name(const char (&name)[N]) {
+        init({name, N - 1});
+    }
+
+    Name(std::string_view name) {
+        init(name);
+    }
+
+    Name(const std::string& name) {
+        init(name);
+    }
+
+    auto str() const -> std::string_view {
+        return {packed_.data() + header_, size_ - header_};
+    }
+
+    // the msgpack representation, header included
+    auto packed() const -> std::string_view {
+        return {packed_.data(), size_};
+    }
+};
+
+// Optional field of a map, left out of the packed map when it's not set
+template <std::size_t N, typename T>
+struct Field {
+    const char (&key)[N];
+    const std::optional<T>& value;
+
+    auto is_set() const -> bool {
+        return value.has_value();
+    }
+
+    template <typename Stream>
+    auto pack(msgpack::packer<Stream>& pk) const -> void {
+        static_assert(N - 1 < 32, "keys are packed as fixstr");
+
+        if (!value)
+            return;
+
+        const auto header = static_cast<char>(0xa0 | (N - 1));
+        pk.pack_bin_body(&header, 1);
+        pk.pack_bin_body(key, N - 1);
+        pk.pack(*value);
+    }
+};
+
+template <std::size_t N, typename T>
+auto field(const char (&key)[N], const std::optional<T>& value) -> Field<N, T> {
+    return {key, value};
+}
+
+// Packs the fields which are set as a map, nothing is packed for the rest
+template <typename Stream, typename... Fields>
+auto pack_fields(msgpack::packer<Stream>& pk, const Fields&... fields) -> void {
+    pk.pack_map(static_cast<std::uint32_t>((std::size_t{fields.is_set()} + ... + 0)));
+    (fields.pack(pk), ...);
+}
+
+} // namespace rpc
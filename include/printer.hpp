@@ -91,3 +91,11 @@ struct fmt::formatter<nvim::Api::any> : fmt::formatter<std::string> {
         return ctx.out();
     }
 };
+
+// views are converted for printing only, which happens when the log level is enabled
+template <>
+struct fmt::formatter<rpc::ObjectView> : fmt::formatter<nvim::Api::any> {
+    auto format(const rpc::ObjectView& view, format_context& ctx) const -> decltype(ctx.out()) {
+        return fmt::formatter<nvim::Api::any>::format(view.as<nvim::Api::any>(), ctx);
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rpc {
+
+// Log of the msgpack traffic of a connection:
+//   header "NVIMRPC1"
+//   frames [direction: u8][time since the recording started, ns: u64][size: u32][msgpack message]
+// Integers are little endian.
+enum class Direction : std::uint8_t { In = 0, Out = 1 };
+
+struct Frame {
+    Direction direction{};
+    std::chrono::nanoseconds time{};
+    std::string data;
+};
+
+class Recorder {
+    static constexpr std::string_view magic = "NVIMRPC1";
+
+    using Clock = std::chrono::steady_clock;
+
+    std::ofstream out_;
+    const Clock::time_point start_{Clock::now()};
+
+    template <typename T>
+    auto put(T value) -> void {
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            out_.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+public:
+    explicit Recorder(const std::string& path)
+        : out_{path, std::ios::binary | std::ios::trunc} {
+        if (!out_)
+            throw std::runtime_error("Can't open " + path + " for recording");
+
+        out_.write(magic.data(), magic.size());
+    }
+
+    auto write(Direction direction, std::string_view message) -> void {
+        const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+
+        put(static_cast<std::uint8_t>(direction));
+        put(static_cast<std::uint64_t>(time.count()));
+        put(static_cast<std::uint32_t>(message.size()));
+        out_.write(message.data(), message.size());
+    }
+
+    // reads a whole recording
+    static auto read(const std::string& path) -> std::vector<Frame> {
+        std::ifstream in{path, std::ios::binary};
+
+        std::string header(magic.size(), '\0');
+        if (!in.read(header.data(), header.size()) || header != magic)
+            throw std::runtime_error(path + " is not an RPC recording");
+
+        const auto get = [&in]<typename T>(T& value) {
+            unsigned char bytes[sizeof(T)];
+            if (!in.read(reinterpret_cast<char*>(bytes), sizeof(T)))
+                return false;
+
+            value = 0;
+            for (std::size_t i = 0; i < sizeof(T); ++i) {
+                value |= static_cast<T>(bytes[i]) << (8 * i);
+            }
+            return true;
+        };
+
+        std::vector<Frame> frames;
+        std::uint8_t direction{};
+        std::uint64_t time{};
+        std::uint32_t size{};
+        while (get(direction) && get(time) && get(size)) {
+            auto& frame = frames.emplace_back(Frame{.direction = static_cast<Direction>(direction),
+                                                    .time = std::chrono::nanoseconds{time},
+                                                    .data = std::string(size, '\0')});
+            if (!in.read(frame.data.data(), size))
+                throw std::runtime_error(path + " is truncated");
+        }
+        return frames;
+    }
+};
+
+} // namespace rpc
@@ -1,41 +1,223 @@
 #pragma once
 
+#include "cache.hpp"
+#include "deadline.hpp"
+#include "error.hpp"
+#include "flight.hpp"
+#include "frame.hpp"
+#include "metrics.hpp"
+#include "object.hpp"
+#include "pack.hpp"
+#include "recorder.hpp"
+#include "slots.hpp"
+#include "subscription.hpp"
+#include "transport.hpp"
+
 #include <boost/asio.hpp>
 #include <boost/cobalt.hpp>
 #include <msgpack.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <optional>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace rpc {
 
-using boost::asio::ip::tcp;
-
 enum class MessageType { Request = 0, Response = 1, Notify = 2 };
 
+// Array of elements which are packed already, e.g. the calls of `nvim_call_atomic`
+struct PackedArray {
+    std::size_t size{};
+    const msgpack::sbuffer& data;
+};
+
+// Outbound queue counters, every flush is a single scatter-gather write of all queued messages
+struct WriteStats {
+    std::size_t messages{};
+    std::size_t flushes{};
+    std::size_t bytes{};
+    std::size_t largest_flush{};
+    std::size_t buffers{}; // message buffers allocated, stays flat once the pool is warm
+};
+
+// Per-call settings, the defaults apply the client's timeout and nothing else
+struct CallOptions {
+    std::chrono::milliseconds timeout{}; // zero falls back to the client's timeout
+    Cancellation* cancellation{};        // must outlive the call
+    std::string_view cache_as{};         // name in the state cache policy instead of the method, e.g. of a helper
+};
+
 class Socket {
-    const std::string host_;
-    const std::uint16_t port_;
-    std::optional<tcp::socket> socket_;
+    const Address address_;
+    std::optional<Transport> socket_;
+
+    // messages waiting for the next flush and messages being written by the current one
+    std::vector<msgpack::sbuffer> queue_;
+    std::vector<msgpack::sbuffer> writing_;
+    std::vector<boost::asio::const_buffer> buffers_;
+
+    // written buffers kept for reuse, oversized ones are freed
+    static constexpr std::size_t spare_limit = 64;
+    static constexpr std::size_t spare_size_limit = 64 * 1024;
+    std::vector<msgpack::sbuffer> spare_;
+
+    // zones of received messages, a zone comes back once the last view of its message is gone
+    struct ZonePool {
+        static constexpr std::size_t limit = 64;
+        static constexpr std::size_t chunk_size = MSGPACK_ZONE_CHUNK_SIZE;
+        std::vector<std::unique_ptr<msgpack::zone>> free;
+        std::size_t allocations{};
+        std::size_t growths{};
+    };
+    std::shared_ptr<ZonePool> zones_{std::make_shared<ZonePool>()};
+    ReceiveBuffer receive_buffer_;
+
+    // opt-in tap of every message in both directions
+    std::shared_ptr<Recorder> recorder_;
+    std::size_t received_size_{};
+    bool flushing_{false};
+    WriteStats write_stats_;
+
+    auto flush() -> boost::cobalt::promise<void> {
+        if (!socket_) {
+            queue_.clear();
+            throw std::runtime_error("RPC connection is closed");
+        }
+
+        // buffers of a failed write are never sent again, the next flush starts with the new messages
+        flushing_ = true;
+        std::shared_ptr<void> reset{nullptr, [this](auto) {
+                                        flushing_ = false;
+                                        writing_.clear();
+                                    }};
+
+        // give all coroutines scheduled in this turn of the event loop a chance to queue their messages
+        co_await boost::asio::post(socket_->get_executor(), boost::cobalt::use_op);
+
+        while (socket_ && !queue_.empty()) {
+            std::swap(queue_, writing_);
+
+            buffers_.clear();
+            for (const auto& buffer : writing_) {
+                buffers_.emplace_back(buffer.data(), buffer.size());
+            }
+
+            std::size_t n{};
+            try {
+                n = co_await boost::asio::async_write(*socket_, buffers_, boost::cobalt::use_op);
+            } catch (const boost::system::system_error& e) {
+                // A partly written message leaves the stream corrupt, the connection is closed and nothing queued
+                // is sent. The client fails the calls in flight once the reader stops.
+                spdlog::error("RPC write failed, closing the connection: {}", e.what());
+                queue_.clear();
+                close();
+                throw;
+            }
+
+            write_stats_.messages += writing_.size();
+            write_stats_.bytes += n;
+            write_stats_.largest_flush = std::max(write_stats_.largest_flush, writing_.size());
+            ++write_stats_.flushes;
+            spdlog::trace("Flushed {} messages, {} bytes", writing_.size(), n);
+
+            for (auto& buffer : writing_) {
+                if (spare_.size() < spare_limit && buffer.size() <= spare_size_limit) {
+                    buffer.clear();
+                    spare_.push_back(std::move(buffer));
+                }
+            }
+            writing_.clear();
+        }
+    }
+
+    // records the message which was just packed into the last queued buffer
+    auto tap() -> void {
+        if (recorder_)
+            recorder_->write(Direction::Out, {queue_.back().data(), queue_.back().size()});
+    }
+
+    auto make_zone() -> std::shared_ptr<msgpack::zone> {
+        std::unique_ptr<msgpack::zone> zone;
+        if (zones_->free.empty()) {
+            zone = std::make_unique<msgpack::zone>(ZonePool::chunk_size);
+            ++zones_->allocations;
+        } else {
+            zone = std::move(zones_->free.back());
+            zones_->free.pop_back();
+        }
+
+        // views may outlive the socket, the zone is freed then
+        return {zone.release(), [pool = std::weak_ptr{zones_}](msgpack::zone* zone) {
+                    const auto zones = pool.lock();
+                    if (zones && zones->free.size() < ZonePool::limit) {
+                        // keeps its first chunk
+                        zone->clear();
+                        zones->free.emplace_back(zone);
+                    } else {
+                        delete zone;
+                    }
+                }};
+    }
+
+    // queues an empty buffer for the next message, reusing a written one if there is any
+    auto next_buffer() -> msgpack::sbuffer& {
+        if (spare_.empty()) {
+            ++write_stats_.buffers;
+            return queue_.emplace_back();
+        }
+
+        queue_.push_back(std::move(spare_.back()));
+        spare_.pop_back();
+        return queue_.back();
+    }
 
 public:
-    Socket(std::string host, std::uint16_t port)
-        : host_{std::move(host)}
-        , port_(port) {}
+    explicit Socket(Address address)
+        : address_{std::move(address)} {}
+
+    // wraps a connected transport, e.g. the server side of a connection
+    explicit Socket(Transport transport)
+        : address_{}
+        , socket_{std::move(transport)} {}
+
+    // the flush and receive coroutines refer to the socket, it stays where it was created
+    Socket(const Socket&) = delete;
+    auto operator=(const Socket&) -> Socket& = delete;
+
+    auto write_stats() const -> const WriteStats& {
+        return write_stats_;
+    }
+
+    auto receive_stats() const -> ReceiveStats {
+        auto stats = receive_buffer_.stats();
+        stats.zone_allocations = zones_->allocations;
+        stats.zone_growths = zones_->growths;
+        return stats;
+    }
 
-    Socket(Socket&& s)
-        : host_{std::move(s.host_)}
-        , port_{s.port_}
-        , socket_(std::move(s.socket_)) {}
+    // starts writing every message to the recorder, null stops it
+    auto record(std::shared_ptr<Recorder> recorder) -> void {
+        recorder_ = std::move(recorder);
+    }
 
     auto close() -> void {
         if (socket_)
@@ -44,47 +226,107 @@ public:
     }
 
     auto connect() -> boost::cobalt::promise<void> {
-        auto ex = co_await boost::asio::this_coro::executor;
-        auto resolver = tcp::resolver{ex};
-        const auto results = co_await resolver.async_resolve(host_, std::to_string(port_), boost::cobalt::use_op);
-
-        auto socket = tcp::socket{ex};
-        co_await boost::asio::async_connect(socket, results, boost::cobalt::use_op);
-        socket_ = std::move(socket);
+        socket_.emplace(co_await Transport::connect(address_));
     }
 
+    // Queues the request, the first sender of an event loop turn writes out everything queued during that turn.
+    // Returns the size of the packed request.
     template <typename... U>
-    auto send(std::uint32_t msgid, const std::string& method, const U&... u) -> boost::cobalt::promise<void> {
-        msgpack::sbuffer buffer;
+    auto send(std::uint32_t msgid, const Name& method, const U&... u) -> boost::cobalt::promise<std::size_t> {
+        static_assert(sizeof...(u) < 16, "arguments are packed as fixarray");
+
+        auto& buffer = next_buffer();
+
+        // [type, msgid, method, [args...]] header in one write: msgid is always packed as uint32,
+        // the method is packed already and the size of the arguments array is known at compile time
+        const auto name = method.packed();
+        std::array<char, 8 + Name::capacity> header{
+            static_cast<char>(0x94), static_cast<char>(MessageType::Request), static_cast<char>(0xce),
+            static_cast<char>(msgid >> 24), static_cast<char>(msgid >> 16), static_cast<char>(msgid >> 8),
+            static_cast<char>(msgid)};
+        std::copy(name.begin(), name.end(), header.begin() + 7);
+        header[7 + name.size()] = static_cast<char>(0x90 | sizeof...(u));
+        buffer.write(header.data(), 8 + name.size());
+
+        msgpack::packer<msgpack::sbuffer> pk(&buffer);
+        (pk.pack(u), ...);
+        tap();
+
+        const auto size = buffer.size();
+        if (!flushing_) {
+            co_await flush();
+        }
+        co_return size;
+    }
+
+    // Queues a response to a request from Neovim, [type, msgid, error, result]
+    template <typename E, typename R>
+    auto reply(std::uint32_t msgid, const E& error, const R& result) -> boost::cobalt::promise<void> {
+        auto& buffer = next_buffer();
         msgpack::packer<msgpack::sbuffer> pk(&buffer);
 
         pk.pack_array(4);
-        pk.pack(static_cast<std::uint32_t>(MessageType::Request));
-        pk.pack(msgid++);
-        pk.pack(method);
-        pk.pack_array(sizeof...(u));
-        if constexpr (sizeof...(u)) {
-            int _[] = {(pk.pack(u), 0)...};
-            (void)_;
+        pk.pack(static_cast<std::uint32_t>(MessageType::Response));
+        pk.pack(msgid);
+        pk.pack(error);
+        pk.pack(result);
+        tap();
+
+        if (!flushing_) {
+            co_await flush();
         }
+    }
+
+    // Queues a notification, [type, method, [args...]]
+    template <typename... U>
+    auto notify(const Name& method, const U&... u) -> boost::cobalt::promise<void> {
+        auto& buffer = next_buffer();
+        msgpack::packer<msgpack::sbuffer> pk(&buffer);
+
+        pk.pack_array(3);
+        pk.pack(static_cast<std::uint32_t>(MessageType::Notify));
+        pk.pack_bin_body(method.packed().data(), method.packed().size());
+        pk.pack_array(sizeof...(u));
+        (pk.pack(u), ...);
+        tap();
 
-        co_await socket_->async_send(boost::asio::buffer(buffer.data(), buffer.size()), boost::cobalt::use_op);
+        if (!flushing_) {
+            co_await flush();
+        }
     }
 
-    auto receive() -> boost::cobalt::generator<msgpack::object> {
-        msgpack::unpacker pac;
-        const auto increase = pac.buffer_capacity();
+    // size of the message yielded last by `receive()`
+    auto received_size() const -> std::size_t {
+        return received_size_;
+    }
 
+    // Yields views of received messages, each one owns the zone of its message.
+    // Messages are cut from the read buffer first and decoded into a pooled zone one at a time.
+    auto receive() -> boost::cobalt::generator<ObjectView> {
         try {
             while (socket_) {
-                pac.reserve_buffer(increase);
-                const auto n = co_await socket_->async_read_some(
-                    boost::asio::buffer(pac.buffer(), pac.buffer_capacity()), boost::cobalt::use_op);
-                pac.buffer_consumed(n);
-
-                msgpack::object_handle oh;
-                while (pac.next(oh)) {
-                    co_yield oh.get();
+                const auto n = co_await socket_->async_read_some(receive_buffer_.prepare(), boost::cobalt::use_op);
+                receive_buffer_.commit(n);
+
+                while (const auto message = receive_buffer_.next()) {
+                    received_size_ = message->size();
+                    if (recorder_)
+                        recorder_->write(Direction::In, *message);
+
+                    // strings are copied into the zone, the read buffer is reused while the view lives on
+                    auto zone = make_zone();
+                    std::size_t offset = 0;
+                    const auto start = reinterpret_cast<std::uintptr_t>(zone->allocate_no_align(0));
+                    const auto object = msgpack::unpack(*zone, message->data(), message->size(), offset);
+
+                    // Relies on msgpack::zone allocating from the start of its first chunk, which `clear()` keeps
+                    // and rewinds to. If the allocation pointer moved further than the chunk size, or before the
+                    // start, the message did not fit and the zone allocated more chunks. Addresses are compared as
+                    // integers, the chunks are unrelated allocations. The extra chunks are freed by `clear()`.
+                    const auto end = reinterpret_cast<std::uintptr_t>(zone->allocate_no_align(0));
+                    if (end - start > ZonePool::chunk_size)
+                        ++zones_->growths;
+                    co_yield ObjectView{std::move(zone), object};
                 }
             }
         } catch (const boost::system::system_error& e) {
@@ -99,10 +341,22 @@ public:
 
 class Client {
 public:
-    Client(std::string host, std::uint16_t port)
-        : socket_{Socket(std::move(host), port)} {}
+    // Serves a request from Neovim, gets the request arguments and returns the result
+    using Handler = std::function<boost::cobalt::task<msgpack::type::variant>(ObjectView args)>;
+
+    // address of Neovim to connect to, see `Address` for the supported formats
+    explicit Client(std::string_view address)
+        : socket_{Socket(Address::parse(address))}
+        , deadlines_{[this](std::uint32_t id) {
+            if (requests_.pending(id))
+                abandon(id, Error{ErrorType::Timeout, "RPC call timed out"});
+        }} {}
+
+    Client(const std::string& host, std::uint16_t port)
+        : Client{host + ":" + std::to_string(port)} {}
 
     auto init() -> boost::cobalt::promise<void> {
+        executor_ = co_await boost::asio::this_coro::executor;
         co_await socket_.connect();
 
         receive_task_.emplace(receive());
@@ -115,82 +369,449 @@ public:
         return channel_;
     }
 
+    auto write_stats() const -> const WriteStats& {
+        return socket_.write_stats();
+    }
+
+    auto receive_stats() const -> ReceiveStats {
+        return socket_.receive_stats();
+    }
+
+    // records the traffic of this connection, see `Recorder`
+    auto record(std::shared_ptr<Recorder> recorder) -> void {
+        socket_.record(std::move(recorder));
+    }
+
+    auto slot_stats() const -> SlotStats {
+        return requests_.stats();
+    }
+
+    // per-method counters of the calls made so far
+    auto metrics() const -> const Metrics& {
+        return metrics_;
+    }
+
+    // Human readable table of the method metrics followed by the counters of the open subscriptions
+    auto report() const -> std::string {
+        auto out = metrics_.report();
+
+        const auto received = socket_.receive_stats();
+        out += fmt::format("\nreceived {} messages, {} bytes, buffer {} bytes, {} buffer and {} zone allocations, "
+                           "{} grown zones, {:.1f} allocations per MB\n",
+                           received.messages, received.bytes, received.capacity, received.buffer_allocations,
+                           received.zone_allocations, received.zone_growths, received.allocations_per_mb());
+
+        if (cache_) {
+            const auto cache = cache_->stats();
+            out += fmt::format("cache: {} hits, {} misses, {:.1f}% hit rate, {} invalidated, {} entries\n", cache.hits,
+                               cache.misses, cache.hit_rate() * 100, cache.invalidations, cache.size);
+        }
+
+        std::vector<std::uint32_t> ids;
+        for (const auto& [id, subscription] : notifications_) {
+            ids.push_back(id);
+        }
+        std::sort(ids.begin(), ids.end());
+
+        out += fmt::format("\n{:<12} {:>8} {:>8} {:>8} {:>8} {:>10} {:>6} {:>6} {:>10} {:>10}\n", "subscription",
+                           "received", "consumed", "dropped", "merged", "bytes", "depth", "max", "lag p50", "lag p99");
+        for (const auto id : ids) {
+            const auto stats = notifications_.at(id)->stats();
+            out += fmt::format("{:<12} {:>8} {:>8} {:>8} {:>8} {:>10} {:>6} {:>6} {:>8}us {:>8}us\n", id,
+                               stats.received, stats.consumed, stats.dropped, stats.coalesced, stats.bytes,
+                               stats.depth, stats.max_depth, stats.lag.percentile(0.5), stats.lag.percentile(0.99));
+        }
+        return out;
+    }
+
+    // Enables deduplication of calls to the given methods: a call with the same arguments as a call in flight
+    // waits for that call's response instead of sending its own. Only for methods without side effects.
+    auto set_single_flight(std::set<std::string, std::less<>> methods) -> void {
+        single_flight_ = std::move(methods);
+    }
+
+    // Caches the results of the methods of the policy until one of their events, see `StateCache`.
+    // Every event of `StateCache::events()` must arrive as a notification with the given id from now on, the reader
+    // invalidates the cache with it before any subscriber of the same event is resumed.
+    auto enable_cache(const std::map<std::string, std::vector<std::string>, std::less<>>& policy, std::uint32_t events)
+        -> void {
+        cache_.emplace(policy);
+        cache_events_ = events;
+    }
+
+    auto invalidate(std::string_view event) -> void {
+        if (cache_)
+            cache_->invalidate(event);
+    }
+
+    auto cache_stats() const -> CacheStats {
+        return cache_ ? cache_->stats() : CacheStats{};
+    }
+
+    // Deadline of calls which don't set their own, zero waits forever. A call past its deadline throws `TimeoutError`.
+    auto set_timeout(std::chrono::milliseconds timeout) -> void {
+        timeout_ = timeout;
+    }
+
+    // Returns a view of the result or the error of the call, it shares the zone of the received response.
+    // Nothing is thrown for failed calls, expected failures like a deleted extmark cost no exception.
     template <typename... Args>
-    auto call(const std::string& method, const Args&... a) -> boost::cobalt::task<msgpack::type::variant> {
-        const auto id = msgid_++;
+    auto try_call_view(CallOptions options, const Name& method, const Args&... a)
+        -> boost::cobalt::task<Result<ObjectView>> {
+        if (options.cancellation && options.cancellation->is_cancelled())
+            co_return std::unexpected(Error{ErrorType::Cancelled, "Call is cancelled: " + std::string{method.str()}});
+
+        auto& stats = metrics_.method(method.str());
+        ++stats.calls;
+
+        // calls with their own deadline or cancellation are always sent
+        const auto plain = !options.timeout.count() && !options.cancellation;
+        const auto cache_name = options.cache_as.empty() ? method.str() : options.cache_as;
+        const auto cached = plain && cache_ && cache_->caches(cache_name);
+        const auto shared = plain && single_flight_.contains(method.str());
+        const auto key = cached || shared ? flight_key(method, a...) : std::string{};
+
+        std::uint64_t epoch{};
+        if (cached) {
+            if (auto hit = cache_->find(key)) {
+                ++stats.cached;
+                co_return std::move(*hit);
+            }
+            epoch = cache_->epoch();
+        }
 
-        auto& channel = requests_[id].emplace(1);
+        // identical calls of allowlisted methods share the response of the one in flight
+        std::shared_ptr<void> landing;
+        if (shared) {
+            if (auto join = flights_.join(key)) {
+                ++stats.shared;
+                co_return co_await *join;
+            }
 
-        co_await socket_.send(id, method, a...);
+            // the waiters get an error if this call fails without a response, e.g. when the socket is closed
+            flights_.start(key);
+            landing = {nullptr, [this, &key](auto) {
+                           flights_.land(key, std::unexpected(Error{ErrorType::Exception, "Shared call failed"}),
+                                         executor_);
+                       }};
+        }
+
+        ++stats.in_flight;
+        std::shared_ptr<void> landed{nullptr, [&stats](auto) {
+                                         --stats.in_flight;
+                                     }};
+        const auto start = std::chrono::steady_clock::now();
+
+        // the slot is released when the response is taken or when this coroutine is destroyed
+        auto completion = requests_.wait(requests_.acquire());
+        const auto id = completion.id();
+
+        // the deadline goes away with the call, before its slot is released
+        const auto timeout = options.timeout.count() ? options.timeout : timeout_;
+        std::shared_ptr<void> deadline;
+        if (timeout.count()) {
+            deadline = {nullptr, [this, id, tick = deadlines_.add(executor_, id, timeout)](auto) {
+                            deadlines_.remove(id, tick);
+                        }};
+        }
+
+        std::shared_ptr<void> unbind;
+        if (options.cancellation) {
+            const auto token = options.cancellation->bind([this, id, name = std::string{method.str()}] {
+                abandon(id, Error{ErrorType::Cancelled, "Call is cancelled: " + name});
+            });
+            unbind = {nullptr, [cancellation = options.cancellation, token](auto) {
+                          cancellation->unbind(token);
+                      }};
+        }
 
-        auto response = co_await channel.read();
-        requests_.erase(id);
-        if (const auto exc = std::get_if<std::exception_ptr>(&response)) {
-            std::rethrow_exception(*exc);
+        stats.bytes_out += co_await socket_.send(id, method, a...);
+
+        auto response = co_await completion;
+        if (response.bytes) {
+            // abandoned calls have no response, their wait is not a latency
+            const auto latency = std::chrono::steady_clock::now() - start;
+            stats.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+            stats.bytes_in += response.bytes;
+        }
+
+        if (!response.value) {
+            ++stats.errors;
+            if (response.value.error().type == ErrorType::Timeout)
+                ++stats.timeouts;
+        }
+        if (cached && response.value)
+            cache_->insert(key, cache_name, *response.value, epoch);
+        if (landing)
+            flights_.land(key, response.value, executor_);
+        co_return std::move(response.value);
+    }
+
+    template <typename... Args>
+    auto try_call_view(const Name& method, const Args&... a) -> boost::cobalt::task<Result<ObjectView>> {
+        return try_call_view(CallOptions{}, method, a...);
+    }
+
+    // decodes the result straight into T, without building a variant first
+    template <typename T = msgpack::type::variant, typename... Args>
+    auto try_call(CallOptions options, const Name& method, const Args&... a) -> boost::cobalt::task<Result<T>> {
+        auto result = co_await try_call_view(options, method, a...);
+        if (!result)
+            co_return std::unexpected(std::move(result).error());
+
+        if constexpr (std::is_void_v<T>) {
+            co_return Result<void>{};
         } else {
-            co_return std::get<msgpack::type::variant>(std::move(response));
+            co_return result->template as<T>();
+        }
+    }
+
+    template <typename T = msgpack::type::variant, typename... Args>
+    auto try_call(const Name& method, const Args&... a) -> boost::cobalt::task<Result<T>> {
+        return try_call<T>(CallOptions{}, method, a...);
+    }
+
+    // Throwing adapters of the calls above, a failed call throws `CallError`, `TimeoutError` or `CancelledError`
+    template <typename... Args>
+    auto call_view(CallOptions options, const Name& method, const Args&... a) -> boost::cobalt::task<ObjectView> {
+        auto result = co_await try_call_view(options, method, a...);
+        if (!result)
+            raise(result.error());
+        co_return std::move(*result);
+    }
+
+    template <typename... Args>
+    auto call_view(const Name& method, const Args&... a) -> boost::cobalt::task<ObjectView> {
+        return call_view(CallOptions{}, method, a...);
+    }
+
+    template <typename T = msgpack::type::variant, typename... Args>
+    auto call(CallOptions options, const Name& method, const Args&... a) -> boost::cobalt::task<T> {
+        auto result = co_await try_call_view(options, method, a...);
+        if (!result)
+            raise(result.error());
+
+        if constexpr (!std::is_void_v<T>) {
+            co_return result->template as<T>();
         }
     }
 
-    auto notification(std::uint32_t id) -> boost::cobalt::generator<msgpack::type::variant> {
-        auto& channel = notifications_[id].emplace(128);
-        auto res = co_await channel.read();
+    template <typename T = msgpack::type::variant, typename... Args>
+    auto call(const Name& method, const Args&... a) -> boost::cobalt::task<T> {
+        return call<T>(CallOptions{}, method, a...);
+    }
+
+    auto notification(std::uint32_t id) -> boost::cobalt::generator<ObjectView> {
+        auto& subscription = subscribe(id, {});
+        auto res = co_await subscription.next();
         notifications_.erase(id);
         co_return res;
     }
 
-    auto notifications(std::uint32_t id) -> boost::cobalt::generator<msgpack::type::variant> {
-        auto& channel = notifications_[id].emplace(128);
+    auto notifications(std::uint32_t id, SubscriptionOptions options = {}) -> boost::cobalt::generator<ObjectView> {
+        auto& subscription = subscribe(id, std::move(options));
 
-        while (channel.is_open()) {
-            co_yield co_await channel.read();
+        while (subscription.is_open()) {
+            co_yield co_await subscription.next();
         }
         co_return {};
     }
 
+    // Registers a handler for `rpcrequest(channel, method, ...)` calls from Neovim.
+    // Every request runs in its own task, so a slow handler doesn't hold back the reader.
+    auto serve(std::string method, Handler handler) -> void {
+        handlers_.insert_or_assign(std::move(method), std::move(handler));
+    }
+
+    auto subscription_stats(std::uint32_t id) const -> SubscriptionStats {
+        const auto it = notifications_.find(id);
+        return it != notifications_.end() ? it->second->stats() : SubscriptionStats{};
+    }
+
 private:
+    auto subscribe(std::uint32_t id, SubscriptionOptions options) -> Subscription& {
+        auto& subscription = notifications_[id];
+        subscription = std::make_unique<Subscription>(std::move(options));
+        return *subscription;
+    }
+
+    // method and packed arguments
+    template <typename... Args>
+    static auto flight_key(const Name& method, const Args&... a) -> std::string {
+        msgpack::sbuffer buffer;
+        buffer.write(method.packed().data(), method.packed().size());
+        msgpack::packer<msgpack::sbuffer> pk(&buffer);
+        (pk.pack(a), ...);
+        return std::string{buffer.data(), buffer.size()};
+    }
+
+    // completes a call in flight with an error instead of its response, the response is dropped if it comes later
+    auto abandon(std::uint32_t id, Error reason) -> void {
+        if (requests_.pending(id) && requests_.complete(id, Response{.value = std::unexpected(std::move(reason))})) {
+            boost::asio::post(executor_, [this, id] {
+                requests_.resume(id);
+            });
+        }
+    }
+
+    // Neovim sends errors as [type, message], other peers may send just the message
+    static auto parse_error(const ObjectView& error) -> Error {
+        if (error.get().type != msgpack::type::ARRAY)
+            return Error{ErrorType::Exception, error.get().type == msgpack::type::STR ? error.as<std::string>() : ""};
+        if (error.size() == 0)
+            return Error{ErrorType::Exception, "Call failed without an error message"};
+
+        const auto message = error[error.size() - 1];
+        auto result = Error{ErrorType::Exception,
+                            message.get().type == msgpack::type::STR ? message.as<std::string>() : std::string{}};
+        if (error.size() > 1 && error[0].get().type == msgpack::type::POSITIVE_INTEGER &&
+            error[0].as<int>() == static_cast<int>(ErrorType::Validation))
+            result.type = ErrorType::Validation;
+        return result;
+    }
+
+    auto unknown(std::uint32_t msgid, std::string method) -> boost::cobalt::task<void> {
+        co_await socket_.reply(msgid, "Unknown method: " + method, msgpack::type::nil_t{});
+    }
+
+    auto respond(std::uint32_t msgid, std::string method, Handler handler, ObjectView args)
+        -> boost::cobalt::task<void> {
+        std::string error;
+        try {
+            const auto result = co_await handler(std::move(args));
+            co_await socket_.reply(msgid, msgpack::type::nil_t{}, result);
+            co_return;
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        spdlog::error("RPC request {} failed: {}", method, error);
+        co_await socket_.reply(msgid, error, msgpack::type::nil_t{});
+    }
+
     auto receive() -> boost::cobalt::promise<void> {
+        auto ex = co_await boost::asio::this_coro::executor;
+        const auto wake = [&](std::uint32_t id) {
+            boost::asio::post(ex, [this, id] {
+                if (const auto it = notifications_.find(id); it != notifications_.end()) {
+                    it->second->resume();
+                }
+            });
+        };
+        const auto complete = [&](std::uint32_t id, ResponseType response) {
+            // the waiting coroutine is resumed from the event loop, not from inside the reader
+            if (requests_.complete(id, Response{.value = std::move(response), .bytes = socket_.received_size()})) {
+                boost::asio::post(ex, [this, id] {
+                    requests_.resume(id);
+                });
+            }
+        };
+
         auto reader = socket_.receive();
         while (reader) {
-            const auto obj = co_await reader;
-            if (obj.is_nil())
+            const auto message = co_await reader;
+            if (message.is_nil())
                 break;
 
-            const auto& message = obj.as<std::vector<msgpack::type::variant>>();
-            const auto mt = static_cast<MessageType>(message[0].as_uint64_t());
-            if (mt == MessageType::Response) {
+            const auto mt = static_cast<MessageType>(message[0].as<std::uint32_t>());
+            if (mt == MessageType::Request) {
+                // [type, id, method, args]
+                const auto msgid = message[1].as<std::uint32_t>();
+                const auto method = message[2].str();
+                const auto it = handlers_.find(method);
+                if (it != handlers_.end()) {
+                    boost::cobalt::spawn(ex, respond(msgid, it->first, it->second, message[3]),
+                                         boost::asio::detached);
+                } else {
+                    spdlog::error("No handler for RPC request {}", method);
+                    boost::cobalt::spawn(ex, unknown(msgid, std::string{method}), boost::asio::detached);
+                }
+            } else if (mt == MessageType::Response) {
                 // [type, id, error, result]
                 assert(message.size() == 4);
-                const auto it = requests_.find(message[1].as_uint64_t());
-                if (it != requests_.end()) {
-                    if (message[2].is_nil()) {
-                        co_await it->second->write(message[3]);
-                    } else {
-                        // errors are returned as array of two elements, where the message is in the end
-                        auto err = message[2].as_vector().back().as_string();
-                        spdlog::error("RPC call returned error: {}", err);
-
-                        co_await it->second->write(std::make_exception_ptr(std::runtime_error(std::move(err))));
-                    }
+                const auto id = message[1].as<std::uint32_t>();
+                const auto error = message[2];
+                if (error.is_nil()) {
+                    complete(id, message[3]);
+                } else {
+                    // the caller decides whether the error is worth logging
+                    auto err = parse_error(error);
+                    spdlog::debug("RPC call returned error: {}", err.message);
+                    complete(id, std::unexpected(std::move(err)));
                 }
             } else if (mt == MessageType::Notify) {
                 // [type, message, args]
-                const auto it = notifications_.find(std::stoi(message[1].as_string()));
-                if (it != notifications_.end()) {
-                    co_await it->second->write(message[2]);
+                const auto method = message[1].str();
+                std::uint32_t id{};
+                std::from_chars(method.data(), method.data() + method.size(), id);
+
+                // the subscribers of an event are only resumed from the event loop, so they can't see stale state
+                if (cache_ && id == cache_events_) {
+                    if (const auto event = message[2][0].find("event"))
+                        invalidate(event->str());
+                    continue;
+                }
+
+                // never suspends, slow subscribers get their overflow policy applied instead
+                const auto it = notifications_.find(id);
+                if (it != notifications_.end() && it->second->push(message[2], socket_.received_size())) {
+                    wake(id);
                 }
             }
         }
+
+        for (auto& [id, subscription] : notifications_) {
+            if (subscription->close()) {
+                wake(id);
+            }
+        }
+
+        // no response comes anymore, e.g. after a failed write closed the connection
+        for (const auto id : requests_.pending_ids()) {
+            abandon(id, Error{ErrorType::Exception, "RPC connection is closed"});
+        }
     }
 
-    using ChannelDataType = std::variant<msgpack::type::variant, std::exception_ptr>;
+    using ResponseType = Result<ObjectView>;
+
+    struct Response {
+        ResponseType value;
+        std::size_t bytes{}; // size of the response message, zero if the call was abandoned
+    };
 
-    std::uint32_t msgid_ = 0;
     std::uint32_t channel_ = 0;
+    boost::asio::any_io_executor executor_;
     Socket socket_;
-    std::unordered_map<std::uint32_t, std::optional<boost::cobalt::channel<ChannelDataType>>> requests_;
-    std::unordered_map<std::uint32_t, std::optional<boost::cobalt::channel<msgpack::type::variant>>> notifications_;
+    SlotTable<Response> requests_;
+    Metrics metrics_;
+    std::set<std::string, std::less<>> single_flight_;
+    SingleFlight<Result<ObjectView>> flights_;
+    std::optional<StateCache> cache_;
+    std::uint32_t cache_events_{}; // notification id of the events which invalidate the cache
+    TimerWheel deadlines_;
+    std::chrono::milliseconds timeout_{};
+    std::unordered_map<std::uint32_t, std::unique_ptr<Subscription>> notifications_;
+    std::map<std::string, Handler, std::less<>> handlers_;
     std::optional<boost::cobalt::promise<void>> receive_task_;
 };
 
 } // namespace rpc
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
+    namespace adaptor {
+
+    template <>
+    struct pack<rpc::PackedArray> {
+        template <typename Stream>
+        auto operator()(msgpack::packer<Stream>& o, const rpc::PackedArray& v) const -> msgpack::packer<Stream>& {
+            o.pack_array(v.size);
+            // body writes the bytes as they are, the elements are valid msgpack already
+            o.pack_bin_body(v.data.data(), v.data.size());
+            return o;
+        }
+    };
+
+    } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+// Counters of the in-flight request table. They cover the table's own storage only: every call still allocates
+// its coroutine frame and its send buffer.
+struct SlotStats {
+    std::size_t acquired{}; // requests sent
+    std::size_t growths{};  // times the table had to grow, stays flat in steady state
+    std::size_t stale{};    // responses for released or unknown ids, dropped
+    std::size_t capacity{};
+    std::size_t in_flight{};
+};
+
+// Preallocated ring of in-flight requests. Ids are a 32-bit sequence and a request takes the slot its id maps to,
+// so slots are reused in order and an id comes back only after 2^32 requests. Responses which arrive after their
+// slot was released don't match its current id, they are recognized and dropped.
+template <typename T>
+class SlotTable {
+public:
+    static constexpr std::size_t max_capacity = std::size_t{1} << 16;
+
+private:
+    struct Slot {
+        std::optional<T> value;
+        std::coroutine_handle<> waiter;
+        std::uint32_t id{};
+        bool busy{};
+    };
+
+    std::vector<Slot> slots_; // the size is a power of two
+    std::uint32_t next_{};    // next id to hand out
+    std::size_t busy_{};
+    SlotStats stats_;
+
+    auto index(std::uint32_t id) const -> std::size_t {
+        return id & (slots_.size() - 1);
+    }
+
+    // returns the slot if the id is the request it holds
+    auto find(std::uint32_t id) -> Slot* {
+        if (slots_.empty())
+            return nullptr;
+
+        auto& slot = slots_[index(id)];
+        return slot.busy && slot.id == id ? &slot : nullptr;
+    }
+
+    auto grow() -> void {
+        const auto size = slots_.size();
+        const auto capacity = std::min<std::size_t>(std::max<std::size_t>(size * 2, 16), max_capacity);
+        if (capacity == size)
+            throw std::runtime_error("Too many requests in flight");
+
+        // requests in flight move to the slots their ids map to in the larger ring
+        std::vector<Slot> slots(capacity);
+        for (auto& slot : slots_) {
+            if (slot.busy)
+                slots[slot.id & (capacity - 1)] = std::move(slot);
+        }
+        slots_ = std::move(slots);
+        ++stats_.growths;
+    }
+
+public:
+    // One-shot wait for the response of a request, releases the slot when resumed or destroyed
+    class Completion {
+        SlotTable& table_;
+        const std::uint32_t id_;
+        bool done_{};
+
+    public:
+        Completion(SlotTable& table, std::uint32_t id)
+            : table_{table}
+            , id_{id} {}
+
+        Completion(const Completion&) = delete;
+        auto operator=(const Completion&) -> Completion& = delete;
+
+        ~Completion() {
+            if (!done_)
+                table_.release(id_);
+        }
+
+        auto id() const -> std::uint32_t {
+            return id_;
+        }
+
+        auto await_ready() -> bool {
+            const auto slot = table_.find(id_);
+            return !slot || slot->value;
+        }
+
+        auto await_suspend(std::coroutine_handle<> waiter) -> void {
+            table_.find(id_)->waiter = waiter;
+        }
+
+        auto await_resume() -> T {
+            const auto slot = table_.find(id_);
+            if (!slot || !slot->value)
+                throw std::logic_error("Request slot was released before completion");
+
+            auto value = std::move(*slot->value);
+            table_.release(id_);
+            done_ = true;
+            return value;
+        }
+    };
+
+    explicit SlotTable(std::size_t initial = 64) {
+        while (slots_.size() < initial) {
+            grow();
+        }
+        stats_.growths = 0;
+    }
+
+    // takes the next free slot, returns the request id for it
+    auto acquire() -> std::uint32_t {
+        if (busy_ == slots_.size())
+            grow();
+
+        // ids of slots still held by slow requests are skipped
+        while (slots_[index(next_)].busy) {
+            ++next_;
+        }
+
+        const auto id = next_++;
+        auto& slot = slots_[index(id)];
+        slot.id = id;
+        slot.busy = true;
+        ++busy_;
+        ++stats_.acquired;
+        return id;
+    }
+
+    auto wait(std::uint32_t id) -> Completion {
+        return Completion{*this, id};
+    }
+
+    // true while the request waits for its response
+    auto pending(std::uint32_t id) -> bool {
+        const auto slot = find(id);
+        return slot && !slot->value;
+    }
+
+    // ids of the requests waiting for their responses
+    auto pending_ids() const -> std::vector<std::uint32_t> {
+        std::vector<std::uint32_t> ids;
+        for (const auto& slot : slots_) {
+            if (slot.busy && !slot.value)
+                ids.push_back(slot.id);
+        }
+        return ids;
+    }
+
+    // stores the response, returns false if the request is not in flight anymore
+    auto complete(std::uint32_t id, T value) -> bool {
+        const auto slot = find(id);
+        if (!slot || slot->value) {
+            ++stats_.stale;
+            return false;
+        }
+
+        slot->value.emplace(std::move(value));
+        return true;
+    }
+
+    // resumes the coroutine waiting for a completed request, if it's still there
+    auto resume(std::uint32_t id) -> void {
+        if (const auto slot = find(id)) {
+            if (const auto waiter = std::exchange(slot->waiter, nullptr)) {
+                waiter.resume();
+            }
+        }
+    }
+
+    auto release(std::uint32_t id) -> void {
+        const auto slot = find(id);
+        if (!slot)
+            return;
+
+        slot->value.reset();
+        slot->waiter = nullptr;
+        slot->busy = false;
+        --busy_;
+    }
+
+    auto stats() const -> SlotStats {
+        auto stats = stats_;
+        stats.capacity = slots_.size();
+        stats.in_flight = busy_;
+        return stats;
+    }
+};
+
+} // namespace rpc
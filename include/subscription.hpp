@@ -0,0 +1,188 @@
+#pragma once
+
+#include "metrics.hpp"
+#include "object.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <utility>
+
+namespace rpc {
+
+// What to do with a notification when the subscriber's queue is full
+enum class Overflow {
+    Grow,       // keep everything, the queue grows beyond its limit
+    DropOldest, // discard the oldest queued notification
+    Coalesce,   // replace a queued notification with the same key, drop the oldest one if there is none
+};
+
+struct SubscriptionOptions {
+    std::size_t limit{128};
+    Overflow overflow{Overflow::Grow};
+
+    // Replace a queued notification with the same key whatever the queue size, so while the subscriber is busy
+    // only the latest notification of each key waits for it
+    bool coalesce{false};
+
+    // key for `coalesce` and `Overflow::Coalesce`, e.g. hash of the event name and buffer of an autocmd
+    std::function<std::size_t(const ObjectView&)> key;
+};
+
+struct SubscriptionStats {
+    std::size_t received{};
+    std::size_t consumed{};
+    std::size_t bytes{}; // received, including the dropped and coalesced notifications
+    std::size_t dropped{};
+    std::size_t coalesced{};
+    std::size_t depth{};
+    std::size_t max_depth{};
+    Histogram lag; // us from receiving a notification to handing it out, a coalesced one keeps its first time
+};
+
+// Queue of notifications for one subscriber. The reader pushes without ever suspending,
+// so a slow subscriber can't hold back responses or other subscribers.
+class Subscription {
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::size_t key{};
+        ObjectView value;
+        Clock::time_point received{};
+    };
+
+    SubscriptionOptions options_;
+    std::deque<Entry> queue_;
+    std::coroutine_handle<> waiter_;
+    SubscriptionStats stats_;
+    bool closed_{};
+    bool wake_pending_{}; // the owner was asked to `resume()` and hasn't yet
+
+    // replaces the queued notification with the same key, false if there is none
+    auto coalesce(Entry& entry) -> bool {
+        const auto it = std::find_if(queue_.begin(), queue_.end(), [&entry](const auto& queued) {
+            return queued.key == entry.key;
+        });
+        if (it == queue_.end())
+            return false;
+
+        it->value = std::move(entry.value);
+        ++stats_.coalesced;
+        return true;
+    }
+
+    auto overflow(Entry& entry) -> void {
+        if (options_.overflow == Overflow::Coalesce && options_.key && coalesce(entry))
+            return;
+
+        queue_.pop_front();
+        queue_.push_back(std::move(entry));
+        ++stats_.dropped;
+    }
+
+    // true if the subscriber waits and no `resume()` is pending yet
+    auto wake() -> bool {
+        if (!waiter_ || wake_pending_)
+            return false;
+        wake_pending_ = true;
+        return true;
+    }
+
+public:
+    class Next {
+        Subscription& subscription_;
+
+    public:
+        explicit Next(Subscription& subscription)
+            : subscription_{subscription} {}
+
+        Next(const Next&) = delete;
+        auto operator=(const Next&) -> Next& = delete;
+
+        ~Next() {
+            subscription_.waiter_ = nullptr;
+        }
+
+        auto await_ready() const -> bool {
+            return !subscription_.queue_.empty() || subscription_.closed_;
+        }
+
+        auto await_suspend(std::coroutine_handle<> waiter) -> void {
+            subscription_.waiter_ = waiter;
+        }
+
+        // nil once the subscription is closed and drained
+        auto await_resume() -> ObjectView {
+            auto& queue = subscription_.queue_;
+            if (queue.empty())
+                return {};
+
+            auto& stats = subscription_.stats_;
+            const auto lag = Clock::now() - queue.front().received;
+            stats.lag.record(std::chrono::duration_cast<std::chrono::microseconds>(lag).count());
+            ++stats.consumed;
+
+            auto value = std::move(queue.front().value);
+            queue.pop_front();
+            return value;
+        }
+    };
+
+    explicit Subscription(SubscriptionOptions options)
+        : options_{std::move(options)} {}
+
+    // Queues the notification, returns true if the subscriber waits for it and has to be resumed.
+    // Only the first notification for a waiting subscriber asks for it, it drains the queue once resumed.
+    auto push(ObjectView value, std::size_t bytes = 0) -> bool {
+        ++stats_.received;
+        stats_.bytes += bytes;
+
+        auto entry =
+            Entry{.key = options_.key ? options_.key(value) : 0, .value = std::move(value), .received = Clock::now()};
+        if (options_.coalesce && options_.key && coalesce(entry)) {
+            // the subscriber is busy, it would have taken the queued one otherwise
+        } else if (options_.overflow != Overflow::Grow && !queue_.empty() && queue_.size() >= options_.limit) {
+            overflow(entry);
+        } else {
+            queue_.push_back(std::move(entry));
+        }
+
+        stats_.max_depth = std::max(stats_.max_depth, queue_.size());
+        return wake();
+    }
+
+    auto next() -> Next {
+        return Next{*this};
+    }
+
+    // resumes the subscriber if there is something for it, otherwise it keeps waiting
+    auto resume() -> void {
+        wake_pending_ = false;
+        if (queue_.empty() && !closed_)
+            return;
+
+        if (const auto waiter = std::exchange(waiter_, nullptr)) {
+            waiter.resume();
+        }
+    }
+
+    auto close() -> bool {
+        closed_ = true;
+        return wake();
+    }
+
+    auto is_open() const -> bool {
+        return !closed_ || !queue_.empty();
+    }
+
+    auto stats() const -> SubscriptionStats {
+        auto stats = stats_;
+        stats.depth = queue_.size();
+        return stats;
+    }
+};
+
+} // namespace rpc
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/cobalt.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include <unistd.h>
+
+namespace rpc {
+
+// Where to connect to, parsed from an address string:
+//   "stdio" or "-"                        stdin/stdout of the process, for a plugin started by `jobstart({rpc = true})`
+//   "unix:/tmp/nvim.sock", "/tmp/nvim.sock" AF_UNIX socket, e.g. `$NVIM` or `--listen /tmp/nvim.sock`,
+//                                          a relative path needs a slash or the prefix, e.g. "./nvim.sock"
+//   "tcp:localhost:6666", "localhost:6666"  TCP, an IPv6 host in brackets, e.g. "[::1]:6666"
+// Anything else, like a host without a port, throws `std::invalid_argument`.
+struct Address {
+    enum class Kind { Tcp, Unix, Stdio };
+
+    Kind kind{Kind::Tcp};
+    std::string host; // host name or socket path
+    std::string port;
+
+    static auto parse(std::string_view address) -> Address {
+        const auto strip = [&address](std::string_view prefix) {
+            if (!address.starts_with(prefix))
+                return false;
+
+            address.remove_prefix(prefix.size());
+            if (address.starts_with("//"))
+                address.remove_prefix(2);
+            return true;
+        };
+
+        if (address == "stdio" || address == "-")
+            return Address{.kind = Kind::Stdio};
+
+        const auto tcp = strip("tcp:");
+        if (!tcp && (strip("unix:") || address.find('/') != address.npos)) {
+            if (address.empty())
+                throw std::invalid_argument("Socket path is empty");
+            return Address{.kind = Kind::Unix, .host = std::string{address}};
+        }
+
+        const auto colon = address.rfind(':');
+        if (colon == address.npos || colon == 0 || colon + 1 == address.size())
+            throw std::invalid_argument("Address must be host:port or a socket path, got: " + std::string{address});
+
+        auto host = address.substr(0, colon);
+        if (host.starts_with('[') && host.ends_with(']'))
+            host = host.substr(1, host.size() - 2);
+
+        return Address{.kind = Kind::Tcp, .host = std::string{host}, .port = std::string{address.substr(colon + 1)}};
+    }
+};
+
+// Reads from stdin and writes to stdout, descriptors are duplicated so closing the stream keeps them open
+class StdioStream {
+    boost::asio::posix::stream_descriptor in_;
+    boost::asio::posix::stream_descriptor out_;
+
+public:
+    using executor_type = boost::asio::any_io_executor;
+
+    explicit StdioStream(const executor_type& ex)
+        : in_{ex, ::dup(STDIN_FILENO)}
+        , out_{ex, ::dup(STDOUT_FILENO)} {}
+
+    auto get_executor() -> executor_type {
+        return in_.get_executor();
+    }
+
+    template <typename MutableBuffers, typename Token>
+    auto async_read_some(const MutableBuffers& buffers, Token&& token) {
+        return in_.async_read_some(buffers, std::forward<Token>(token));
+    }
+
+    template <typename ConstBuffers, typename Token>
+    auto async_write_some(const ConstBuffers& buffers, Token&& token) {
+        return out_.async_write_some(buffers, std::forward<Token>(token));
+    }
+
+    auto close() -> void {
+        in_.close();
+        out_.close();
+    }
+};
+
+// Byte stream to Neovim, one of TCP, AF_UNIX socket or stdio pipes.
+// Models asio AsyncReadStream and AsyncWriteStream, so composed operations like `async_write` work on it.
+class Transport {
+public:
+    using Stream = std::variant<boost::asio::ip::tcp::socket, boost::asio::local::stream_protocol::socket, StdioStream>;
+    using executor_type = boost::asio::any_io_executor;
+
+private:
+    Stream stream_;
+
+public:
+    // adopts a connected stream, e.g. one accepted by a server
+    explicit Transport(Stream stream)
+        : stream_{std::move(stream)} {}
+
+    static auto connect(Address address) -> boost::cobalt::promise<Transport> {
+        auto ex = co_await boost::asio::this_coro::executor;
+
+        if (address.kind == Address::Kind::Stdio) {
+            co_return Transport{StdioStream{ex}};
+        }
+
+        if (address.kind == Address::Kind::Unix) {
+            using boost::asio::local::stream_protocol;
+
+            auto socket = stream_protocol::socket{ex};
+            co_await socket.async_connect(stream_protocol::endpoint{address.host}, boost::cobalt::use_op);
+            co_return Transport{std::move(socket)};
+        }
+
+        using boost::asio::ip::tcp;
+
+        auto resolver = tcp::resolver{ex};
+        const auto results = co_await resolver.async_resolve(address.host, address.port, boost::cobalt::use_op);
+
+        auto socket = tcp::socket{ex};
+        co_await boost::asio::async_connect(socket, results, boost::cobalt::use_op);
+
+        // writes are coalesced already, don't let Nagle delay them
+        socket.set_option(tcp::no_delay(true));
+        co_return Transport{std::move(socket)};
+    }
+
+    auto get_executor() -> executor_type {
+        return std::visit(
+            [](auto& s) -> executor_type {
+                return s.get_executor();
+            },
+            stream_);
+    }
+
+    template <typename MutableBuffers, typename Token>
+    auto async_read_some(const MutableBuffers& buffers, Token&& token) {
+        return boost::asio::async_initiate<Token, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const MutableBuffers& buffers) {
+                std::visit(
+                    [&](auto& s) {
+                        s.async_read_some(buffers, std::move(handler));
+                    },
+                    stream_);
+            },
+            token, buffers);
+    }
+
+    template <typename ConstBuffers, typename Token>
+    auto async_write_some(const ConstBuffers& buffers, Token&& token) {
+        return boost::asio::async_initiate<Token, void(boost::system::error_code, std::size_t)>(
+            [this](auto handler, const ConstBuffers& buffers) {
+                std::visit(
+                    [&](auto& s) {
+                        s.async_write_some(buffers, std::move(handler));
+                    },
+                    stream_);
+            },
+            token, buffers);
+    }
+
+    auto close() -> void {
+        std::visit(
+            [](auto& s) {
+                s.close();
+            },
+            stream_);
+    }
+};
+
+} // namespace rpc
@@ -3,997 +3,2551 @@
 #include "rpc.hpp"
 
 #include <fmt/format.h>
-#include <range/v3/all.hpp>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
 #include <memory>
-#include <sstream>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
 
 namespace nvim {
 
-template <typename T, typename Func>
-inline auto transform(const T& from, Func&& f) {
-    auto r = ranges::views::transform(from, std::move(f));
-    return std::vector<decltype(f(*from.begin()))>{r.begin(), r.end()};
+namespace {
+
+// Helper module, registered once per connection by `Api::create()` and called by name with `call_helper_lua`,
+// so calls are plain msgpack arguments and results instead of Lua source built for every call
+constexpr auto helpers_lua = R"(
+local M = {}
+local uv = vim.uv or vim.loop
+
+-- buffer allowlists of the event filters by name
+M.buffers = {}
+
+function M.allow_buffer(name, buf, allowed)
+  M.buffers[name] = M.buffers[name] or {}
+  M.buffers[name][buf] = allowed or nil
+end
+
+-- sends the last event of a burst once no event came for ms, the timer of a key is closed once it fired
+local function debounce(ms, send)
+  local timers, last = {}, {}
+  return function(key, ev)
+    last[key] = ev
+    local timer = timers[key]
+    if not timer then
+      timer = uv.new_timer()
+      timers[key] = timer
+    end
+    timer:stop()
+    timer:start(ms, 0, function()
+      timers[key] = nil
+      timer:close()
+      local pending = last[key]
+      last[key] = nil
+      if pending then vim.schedule(function() send(pending) end) end
+    end)
+  end
+end
+
+-- sends the first event at once and then at most one per ms, the last one of a burst is never lost,
+-- nothing is kept for a key once it was quiet for ms
+local function throttle(ms, send)
+  local pending, waiting = {}, {}
+  local function wait(key)
+    waiting[key] = true
+    vim.defer_fn(function()
+      local last = pending[key]
+      pending[key] = nil
+      if last then
+        send(last)
+        wait(key)
+      else
+        waiting[key] = nil
+      end
+    end, ms)
+  end
+  return function(key, ev)
+    if waiting[key] then
+      pending[key] = ev
+      return
+    end
+    send(ev)
+    wait(key)
+  end
+end
+
+-- the callback can't be passed over RPC, so it's set here to forward the event to the client
+function M.create_autocmd(chan, id, event, opts, filter)
+  filter = filter or {}
+
+  local function send(ev)
+    if filter.fields then
+      local projected = {}
+      for _, field in ipairs(filter.fields) do projected[field] = ev[field] end
+      ev = projected
+    end
+    vim.rpcnotify(chan, id, ev)
+  end
+
+  local forward = function(_, ev) send(ev) end
+  if filter.debounce then
+    forward = debounce(filter.debounce, send)
+  elseif filter.throttle then
+    forward = throttle(filter.throttle, send)
+  end
+
+  opts.callback = function(ev)
+    ev.win = vim.api.nvim_get_current_win()
+    if filter.buffers then
+      local allowed = M.buffers[filter.buffers]
+      if not allowed or not allowed[ev.buf] then return end
+    end
+    forward(ev.event .. ':' .. ev.buf .. ':' .. ev.win .. ':' .. ev.file, ev)
+  end
+  return vim.api.nvim_create_autocmd(event, opts)
+end
+
+-- Queries to the terminal Neovim runs in. The tty handles are opened once, but the terminal is only read while a
+-- query waits for its reply, so keystrokes are left to Neovim otherwise. A reply is matched to the oldest query
+-- waiting for it, as the terminal answers in order. The timer only fires if no reply came.
+local terminal = { pending = {}, input = '' }
+
+-- stops reading once nothing waits, whatever was read and not matched is dropped with it
+local function terminal_idle()
+  if terminal.pending[1] then return end
+  terminal.stdin:read_stop()
+  terminal.input = ''
+end
+
+local function terminal_receive(err, data)
+  if err or not data or not terminal.pending[1] then return end
+  terminal.input = terminal.input .. data
+  while terminal.pending[1] do
+    local query = terminal.pending[1]
+    local first, last = terminal.input:find(query.reply)
+    if not first then break end
+    table.remove(terminal.pending, 1)
+    query.timer:stop()
+    query.timer:close()
+    local reply = terminal.input:sub(first, last)
+    terminal.input = terminal.input:sub(last + 1)
+    vim.rpcnotify(query.chan, query.id, reply)
+  end
+  terminal_idle()
+end
+
+function M.terminal_query(chan, id, data, reply, timeout)
+  if not terminal.stdin then
+    terminal.stdin = uv.new_tty(0, true)
+    terminal.stdout = uv.new_tty(1, false)
+  end
+
+  local query = { chan = chan, id = id, reply = reply, timer = uv.new_timer() }
+  table.insert(terminal.pending, query)
+  if #terminal.pending == 1 then terminal.stdin:read_start(terminal_receive) end
+
+  query.timer:start(timeout, 0, function()
+    for i, pending in ipairs(terminal.pending) do
+      if pending == query then table.remove(terminal.pending, i) break end
+    end
+    query.timer:close()
+    -- a partial reply can't be matched anymore
+    terminal.input = ''
+    terminal_idle()
+    vim.rpcnotify(chan, id, '')
+  end)
+  terminal.stdout:write(data)
+end
+
+function M.visible_lines(win)
+  return vim.api.nvim_win_call(win, function()
+    return { first = vim.fn.line('w0'), last = vim.fn.line('w$') }
+  end)
+end
+
+-- Screen cell of a window, one-based like a cursor position report, unless only the offsets are asked for, and
+-- the offsets of its first text cell from it. The offsets change without the window moving, e.g. with the number
+-- column getting wider or the first sign showing up.
+function M.window_origin(win, offsets_only)
+  local info = vim.fn.getwininfo(win)[1]
+  local origin = { row = 0, col = 0, top = info.winbar, left = info.textoff }
+  if not offsets_only then
+    local pos = vim.api.nvim_win_get_position(win)
+    origin.row, origin.col = pos[1] + 1, pos[2] + 1
+  end
+
+  -- a float is positioned by its border
+  local config = vim.api.nvim_win_get_config(win)
+  if config.relative ~= '' and type(config.border) == 'table' and #config.border > 0 then
+    local function drawn(i)
+      local c = config.border[(i - 1) % #config.border + 1]
+      return (type(c) == 'table' and c[1] or c) ~= ''
+    end
+    if drawn(2) then origin.top = origin.top + 1 end
+    if drawn(8) then origin.left = origin.left + 1 end
+  end
+  return origin
+end
+
+function M.getpid()
+  return vim.fn.getpid()
+end
+
+_G.jupyter_nvim = M
+)";
+
+// [name, args...]
+constexpr auto call_helper_lua = "local name = ...; return jupyter_nvim[name](select(2, ...))";
+
+} // namespace
+
+struct Api::Lanes {
+    std::string address;
+    std::shared_ptr<rpc::Client> interactive;
+    std::shared_ptr<rpc::Client> bulk;
+    std::chrono::milliseconds timeout{};
+    std::set<std::string, std::less<>> single_flight;
+    int notification_ids{};
+};
+
+Api::Api(std::string_view address)
+    : lanes_(std::make_shared<Lanes>(Lanes{.address = std::string{address},
+                                           .interactive = std::make_shared<rpc::Client>(address)}))
+    , rpc_(lanes_->interactive) {}
+
+auto Api::create(std::string address) -> promise<Api> {
+    auto api = Api{address};
+    co_await api.rpc_->init();
+    co_await api.rpc_->call<void>("nvim_exec_lua", helpers_lua, std::make_tuple());
+    co_return api;
 }
 
-struct LuaVisitor : boost::static_visitor<void> {
-    std::ostream& s_;
-    mutable bool is_value_{false};
+auto Api::create(std::string host, std::uint16_t port) -> promise<Api> {
+    co_return co_await create(fmt::format("{}:{}", host, port));
+}
 
-    LuaVisitor(std::ostream& os)
-        : s_{os} {}
+auto Api::rpc_channel() const -> int {
+    return lanes_->interactive->channel();
+}
 
-    void operator()(uint64_t v) const {
-        s_ << v;
-    }
+auto Api::open_bulk_lane() -> promise<void> {
+    if (lanes_->bulk)
+        co_return;
 
-    void operator()(const msgpack::type::raw_ref& v) const {
-        s_ << v.str();
+    if (rpc::Address::parse(lanes_->address).kind == rpc::Address::Kind::Stdio) {
+        spdlog::info("Bulk lane is not available on stdio, bulk calls use the interactive lane");
+        co_return;
     }
 
-    void operator()(const std::string& v) const {
-        if (is_value_) {
-            s_ << '"' << v << '"';
-        } else {
-            s_ << v;
-        }
-    }
+    auto bulk = std::make_shared<rpc::Client>(lanes_->address);
+    bulk->set_timeout(lanes_->timeout);
+    bulk->set_single_flight(lanes_->single_flight);
+    co_await bulk->init();
+    lanes_->bulk = std::move(bulk);
+}
 
-    void operator()(const std::vector<std::string>& v) const {
-        s_ << "{";
-        for (auto& e : v) {
-            s_ << '"' << e << '"' << ",";
-        }
-        s_ << "}";
-    }
+auto Api::lane(Lane lane) const -> Api {
+    auto api = *this;
+    api.rpc_ = lane == Lane::Bulk && lanes_->bulk ? lanes_->bulk : lanes_->interactive;
+    return api;
+}
 
-    void operator()(const std::vector<msgpack::type::variant>& v) const {
-        s_ << "{";
-        for (auto& e : v) {
-            is_value_ = true;
-            boost::apply_visitor(*this, e);
-            s_ << ",";
-        }
-        s_ << "}";
-    }
+auto Api::cancellable(rpc::Cancellation& cancellation) const -> Api {
+    auto api = *this;
+    api.cancellation_ = &cancellation;
+    return api;
+}
 
-    void operator()(const std::multimap<msgpack::type::variant, msgpack::type::variant>& v) const {
-        s_ << "{";
-        for (const auto& [k, v] : v) {
-            if constexpr (std::is_same_v<std::decay_t<decltype(k)>, std::string>) {
-                (*this)(k);
-            } else {
-                is_value_ = false;
-                boost::apply_visitor(*this, k);
-            }
-            s_ << "=";
-            is_value_ = true;
-            boost::apply_visitor(*this, v);
-            s_ << ",";
-        }
-        s_ << "}";
-    }
+auto Api::options() const -> rpc::CallOptions {
+    return rpc::CallOptions{.cancellation = cancellation_};
+}
 
-    template <typename T>
-    void operator()(T const&) const {
-        assert(false && "not supported type");
-    }
-};
-Api::Api(std::string host, std::uint16_t port)
-    : rpc_(std::make_shared<rpc::Client>(std::move(host), port)) {}
+auto Api::record(const std::string& path) -> void {
+    lanes_->interactive->record(std::make_shared<rpc::Recorder>(path));
+}
 
-auto Api::create(std::string host, std::uint16_t port) -> promise<Api> {
-    auto api = Api{std::move(host), port};
-    co_await api.rpc_->init();
-    co_return api;
+auto Api::set_timeout(std::chrono::milliseconds timeout) -> void {
+    lanes_->timeout = timeout;
+    lanes_->interactive->set_timeout(timeout);
+    if (lanes_->bulk)
+        lanes_->bulk->set_timeout(timeout);
 }
 
-auto Api::rpc_channel() const -> int {
-    return rpc_->channel();
+auto Api::read_only_methods() -> std::set<std::string, std::less<>> {
+    // nvim_create_namespace creates the namespace once and returns the same id for the same name after that
+    return {
+        "nvim_buf_get_extmark_by_id",
+        "nvim_buf_get_extmarks",
+        "nvim_buf_get_lines",
+        "nvim_buf_get_name",
+        "nvim_create_namespace",
+        "nvim_get_current_buf",
+        "nvim_get_current_line",
+        "nvim_get_current_win",
+        "nvim_get_mode",
+        "nvim_get_option_value",
+        "nvim_list_wins",
+        "nvim_win_get_buf",
+        "nvim_win_get_config",
+        "nvim_win_get_cursor",
+        "nvim_win_get_height",
+        "nvim_win_get_position",
+        "nvim_win_get_width",
+    };
+}
+
+auto Api::enable_single_flight(std::set<std::string, std::less<>> methods) -> void {
+    lanes_->single_flight = std::move(methods);
+    lanes_->interactive->set_single_flight(lanes_->single_flight);
+    if (lanes_->bulk)
+        lanes_->bulk->set_single_flight(lanes_->single_flight);
+}
+
+auto Api::layout_events() -> std::vector<std::string> {
+    return {"VimResized", "WinResized", "WinNew", "WinClosed", "TabEnter", "BufWinEnter"};
+}
+
+auto Api::state_cache_policy() -> std::map<std::string, std::vector<std::string>, std::less<>> {
+    return {
+        {"nvim_get_current_buf", {"BufEnter", "WinEnter"}},
+        {"nvim_get_current_win", {"WinEnter"}},
+        {"nvim_win_get_height", layout_events()},
+        {"nvim_win_get_position", layout_events()},
+        {"nvim_win_get_width", layout_events()},
+        // the helper, first and last line move with scrolling and edits
+        {"visible_lines", {"BufEnter", "WinEnter", "WinResized", "VimResized", "WinScrolled", "TextChanged",
+                           "TextChangedI"}},
+    };
+}
+
+auto Api::enable_state_cache(integer augroup) -> promise<void> {
+    const auto& rpc = lanes_->interactive;
+    const auto policy = state_cache_policy();
+    const auto id = next_notification_id();
+
+    // the cache may only be used once every event reaches it
+    co_await rpc->call<void>("nvim_exec_lua", call_helper_lua,
+                             std::make_tuple("create_autocmd", rpc->channel(), std::to_string(id),
+                                             rpc::StateCache{policy}.events(),
+                                             AutocmdOpts{.group = augroup, .desc = "jupyter.nvim state cache"},
+                                             // the name of the event is all the cache needs
+                                             EventFilter{.fields = std::vector<std::string>{"event"}}));
+    rpc->enable_cache(policy, id);
+}
+
+auto Api::metrics_report() const -> std::string {
+    auto report = lanes_->interactive->report();
+    if (lanes_->bulk)
+        report += "\nbulk lane\n" + lanes_->bulk->report();
+    return report;
 }
 
 auto Api::next_notification_id() -> int {
-    return ++notification_id_cnt_;
+    return ++lanes_->notification_ids;
 }
 
-auto Api::notification(std::uint32_t id) -> promise<any> {
-    co_return co_await rpc_->notification(id);
+auto Api::notification(std::uint32_t id) -> promise<view> {
+    co_return co_await lanes_->interactive->notification(id);
 }
 
-auto Api::notifications(std::uint32_t id) -> Api::generator<any> {
-    auto gen = rpc_->notifications(id);
+auto Api::notifications(std::uint32_t id, rpc::SubscriptionOptions options) -> Api::generator<view> {
+    auto gen = lanes_->interactive->notifications(id, std::move(options));
     while (gen) {
         co_yield co_await gen;
     }
     co_return {};
 }
 
-auto Api::nvim_buf_add_highlight(integer buffer, integer ns_id, string hl_group, integer line, integer col_start,
-                                 integer col_end) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_add_highlight", buffer, ns_id, hl_group, line, col_start, col_end);
-    co_return std::move(response.as_uint64_t());
+auto Api::serve(std::string method, std::function<task<any>(view args)> handler) -> void {
+    lanes_->interactive->serve(std::move(method), std::move(handler));
 }
 
-auto Api::nvim_buf_attach(integer buffer, boolean send_buffer, table<string, any> opts) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_buf_attach", buffer, send_buffer, opts);
-    co_return std::move(response.as_bool());
+auto Api::batch() -> Batch {
+    return Batch{rpc_, cancellation_};
 }
 
-auto Api::nvim_buf_call(integer buffer, function) -> promise<any> {
-    co_return co_await rpc_->call("nvim_buf_call", buffer);
+auto Api::try_nvim_buf_add_highlight(integer buffer, integer ns_id, string hl_group, integer line, integer col_start,
+                                     integer col_end) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_add_highlight", buffer, ns_id, hl_group, line,
+                                               col_start, col_end);
 }
 
-auto Api::nvim_buf_clear_highlight(integer buffer, integer ns_id, integer line_start, integer line_end)
-    -> promise<void> {
-    co_await rpc_->call("nvim_buf_clear_highlight", buffer, ns_id, line_start, line_end);
+auto Api::try_nvim_buf_attach(integer buffer, boolean send_buffer, table<string, any> opts)
+    -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_buf_attach", buffer, send_buffer, opts);
 }
 
-auto Api::nvim_buf_clear_namespace(integer buffer, integer ns_id, integer line_start, integer line_end)
-    -> promise<void> {
-    co_await rpc_->call("nvim_buf_clear_namespace", buffer, ns_id, line_start, line_end);
+auto Api::try_nvim_buf_call(integer buffer, function) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_buf_call", buffer);
 }
 
-auto Api::nvim_buf_create_user_command(integer buffer, string name, any command, table<string, any> opts)
-    -> promise<void> {
-    co_await rpc_->call("nvim_buf_create_user_command", buffer, name, command, opts);
+auto Api::try_nvim_buf_clear_highlight(integer buffer, integer ns_id, integer line_start, integer line_end)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_clear_highlight", buffer, ns_id, line_start, line_end);
 }
 
-auto Api::nvim_buf_del_extmark(integer buffer, integer ns_id, integer id) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_buf_del_extmark", buffer, ns_id, id);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_buf_clear_namespace(integer buffer, integer ns_id, integer line_start, integer line_end)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_clear_namespace", buffer, ns_id, line_start, line_end);
 }
 
-auto Api::nvim_buf_del_keymap(integer buffer, string mode, string lhs) -> promise<void> {
-    co_await rpc_->call("nvim_buf_del_keymap", buffer, mode, lhs);
+auto Api::try_nvim_buf_create_user_command(integer buffer, string name, any command, table<string, any> opts)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_create_user_command", buffer, name, command, opts);
 }
 
-auto Api::nvim_buf_del_mark(integer buffer, string name) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_buf_del_mark", buffer, name);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_buf_del_extmark(integer buffer, integer ns_id, integer id) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_buf_del_extmark", buffer, ns_id, id);
 }
 
-auto Api::nvim_buf_del_user_command(integer buffer, string name) -> promise<void> {
-    co_await rpc_->call("nvim_buf_del_user_command", buffer, name);
+auto Api::try_nvim_buf_del_keymap(integer buffer, string mode, string lhs) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_del_keymap", buffer, mode, lhs);
 }
 
-auto Api::nvim_buf_del_var(integer buffer, string name) -> promise<void> {
-    co_await rpc_->call("nvim_buf_del_var", buffer, name);
+auto Api::try_nvim_buf_del_mark(integer buffer, string name) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_buf_del_mark", buffer, name);
 }
 
-auto Api::nvim_buf_delete(integer buffer, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_buf_delete", buffer, opts);
+auto Api::try_nvim_buf_del_user_command(integer buffer, string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_del_user_command", buffer, name);
 }
 
-auto Api::nvim_buf_get_changedtick(integer buffer) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_get_changedtick", buffer);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_buf_del_var(integer buffer, string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_del_var", buffer, name);
 }
 
-auto Api::nvim_buf_get_commands(integer buffer, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_buf_get_commands", buffer, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_buf_delete(integer buffer, table<string, any> opts) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_delete", buffer, opts);
 }
 
-auto Api::nvim_buf_get_extmark_by_id(integer buffer, integer ns_id, integer id, table<string, any> opts)
-    -> promise<any> {
-    co_return co_await rpc_->call("nvim_buf_get_extmark_by_id", buffer, ns_id, id, opts);
+auto Api::try_nvim_buf_get_changedtick(integer buffer) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_get_changedtick", buffer);
 }
 
-auto Api::nvim_buf_get_extmarks(integer buffer, integer ns_id, any start, any end_, table<string, any> opts)
-    -> promise<std::vector<any>> {
-    auto response = co_await rpc_->call("nvim_buf_get_extmarks", buffer, ns_id, start, end_, opts);
-    co_return std::move(response.as_vector());
+auto Api::try_nvim_buf_get_commands(integer buffer, table<string, any> opts)
+    -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_buf_get_commands", buffer, opts);
 }
 
-auto Api::nvim_buf_get_keymap(integer buffer, string mode) -> promise<std::vector<table<string, any>>> {
-    auto response = co_await rpc_->call("nvim_buf_get_keymap", buffer, mode);
-    std::vector<table<string, any>> result;
-    for (const auto& elem : response.as_vector()) {
-        table<string, any> res;
-        for (const auto& [k, v] : elem.as_multimap()) {
-            res.emplace(k.as_string(), v);
-        }
-        result.emplace_back(std::move(res));
-    }
-    co_return std::move(result);
+auto Api::try_nvim_buf_get_extmark_by_id(integer buffer, integer ns_id, integer id, table<string, any> opts)
+    -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_buf_get_extmark_by_id", buffer, ns_id, id, opts);
 }
 
-auto Api::nvim_buf_get_lines(integer buffer, integer start, integer end_, boolean strict_indexing)
-    -> promise<std::vector<string>> {
-    auto response = co_await rpc_->call("nvim_buf_get_lines", buffer, start, end_, strict_indexing);
-    co_return transform(response.as_vector(), [](auto t) -> string {
-        return t.as_string();
-    });
+auto Api::try_nvim_buf_get_extmarks(integer buffer, integer ns_id, any start, any end_, table<string, any> opts)
+    -> promise<rpc::Result<std::vector<any>>> {
+    co_return co_await rpc_->try_call<std::vector<any>>(options(), "nvim_buf_get_extmarks", buffer, ns_id, start, end_,
+                                                        opts);
 }
 
-auto Api::nvim_buf_get_mark(integer buffer, string name) -> promise<std::vector<integer>> {
-    auto response = co_await rpc_->call("nvim_buf_get_mark", buffer, name);
-    co_return transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
+auto Api::try_nvim_buf_get_keymap(integer buffer, string mode)
+    -> promise<rpc::Result<std::vector<table<string, any>>>> {
+    co_return co_await rpc_->try_call<std::vector<table<string, any>>>(options(), "nvim_buf_get_keymap", buffer, mode);
 }
 
-auto Api::nvim_buf_get_name(integer buffer) -> promise<string> {
-    auto response = co_await rpc_->call("nvim_buf_get_name", buffer);
-    co_return std::move(response.as_string());
+auto Api::try_nvim_buf_get_lines(integer buffer, integer start, integer end_, boolean strict_indexing)
+    -> promise<rpc::Result<std::vector<string>>> {
+    co_return co_await rpc_->try_call<std::vector<string>>(options(), "nvim_buf_get_lines", buffer, start, end_,
+                                                           strict_indexing);
 }
 
-auto Api::nvim_buf_get_number(integer buffer) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_get_number", buffer);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_buf_get_mark(integer buffer, string name) -> promise<rpc::Result<std::vector<integer>>> {
+    co_return co_await rpc_->try_call<std::vector<integer>>(options(), "nvim_buf_get_mark", buffer, name);
 }
 
-auto Api::nvim_buf_get_offset(integer buffer, integer index) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_get_offset", buffer, index);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_buf_get_name(integer buffer) -> promise<rpc::Result<string>> {
+    co_return co_await rpc_->try_call<string>(options(), "nvim_buf_get_name", buffer);
 }
 
-auto Api::nvim_buf_get_option(integer buffer, string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_buf_get_option", buffer, name);
+auto Api::try_nvim_buf_get_number(integer buffer) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_get_number", buffer);
 }
 
-auto Api::nvim_buf_get_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
-                            table<string, any> opts) -> promise<std::vector<string>> {
-    auto response = co_await rpc_->call("nvim_buf_get_text", buffer, start_row, start_col, end_row, end_col, opts);
-    co_return transform(response.as_vector(), [](auto t) -> string {
-        return t.as_string();
-    });
+auto Api::try_nvim_buf_get_offset(integer buffer, integer index) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_get_offset", buffer, index);
 }
 
-auto Api::nvim_buf_get_var(integer buffer, string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_buf_get_var", buffer, name);
+auto Api::try_nvim_buf_get_option(integer buffer, string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_buf_get_option", buffer, name);
 }
 
-auto Api::nvim_buf_is_loaded(integer buffer) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_buf_is_loaded", buffer);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_buf_get_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                                table<string, any> opts) -> promise<rpc::Result<std::vector<string>>> {
+    co_return co_await rpc_->try_call<std::vector<string>>(options(), "nvim_buf_get_text", buffer, start_row, start_col,
+                                                           end_row, end_col, opts);
 }
 
-auto Api::nvim_buf_is_valid(integer buffer) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_buf_is_valid", buffer);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_buf_get_var(integer buffer, string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_buf_get_var", buffer, name);
 }
 
-auto Api::nvim_buf_line_count(integer buffer) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_line_count", buffer);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_buf_is_loaded(integer buffer) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_buf_is_loaded", buffer);
 }
 
-auto Api::nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
-    -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_buf_is_valid(integer buffer) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_buf_is_valid", buffer);
 }
 
-auto Api::nvim_buf_set_keymap(integer buffer, string mode, string lhs, string rhs, table<string, any> opts)
-    -> promise<void> {
-    co_await rpc_->call("nvim_buf_set_keymap", buffer, mode, lhs, rhs, opts);
+auto Api::try_nvim_buf_line_count(integer buffer) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_line_count", buffer);
 }
 
-auto Api::nvim_buf_set_lines(integer buffer, integer start, integer end_, boolean strict_indexing,
-                             std::vector<string> replacement) -> promise<void> {
-    co_await rpc_->call("nvim_buf_set_lines", buffer, start, end_, strict_indexing, replacement);
+auto Api::try_nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
+    -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
 }
 
-auto Api::nvim_buf_set_mark(integer buffer, string name, integer line, integer col, table<string, any> opts)
-    -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_buf_set_mark", buffer, name, line, col, opts);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, ExtmarkOpts opts)
+    -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
 }
 
-auto Api::nvim_buf_set_name(integer buffer, string name) -> promise<void> {
-    co_await rpc_->call("nvim_buf_set_name", buffer, name);
+auto Api::try_nvim_buf_set_keymap(integer buffer, string mode, string lhs, string rhs, table<string, any> opts)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_set_keymap", buffer, mode, lhs, rhs, opts);
 }
 
-auto Api::nvim_buf_set_option(integer buffer, string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_buf_set_option", buffer, name, value);
+auto Api::try_nvim_buf_set_lines(integer buffer, integer start, integer end_, boolean strict_indexing,
+                                 std::vector<string> replacement) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_set_lines", buffer, start, end_, strict_indexing,
+                                            replacement);
 }
 
-auto Api::nvim_buf_set_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
-                            std::vector<string> replacement) -> promise<void> {
-    co_await rpc_->call("nvim_buf_set_text", buffer, start_row, start_col, end_row, end_col, replacement);
+auto Api::try_nvim_buf_set_mark(integer buffer, string name, integer line, integer col, table<string, any> opts)
+    -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_buf_set_mark", buffer, name, line, col, opts);
 }
 
-auto Api::nvim_buf_set_var(integer buffer, string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_buf_set_var", buffer, name, value);
+auto Api::try_nvim_buf_set_name(integer buffer, string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_set_name", buffer, name);
 }
 
-auto Api::nvim_buf_set_virtual_text(integer buffer, integer src_id, integer line, std::vector<any> chunks,
-                                    table<string, any> opts) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_buf_set_virtual_text", buffer, src_id, line, chunks, opts);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_buf_set_option(integer buffer, string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_set_option", buffer, name, value);
 }
 
-auto Api::nvim_call_dict_function(any dict, string fn, std::vector<any> args) -> promise<any> {
-    co_return co_await rpc_->call("nvim_call_dict_function", dict, fn, args);
+auto Api::try_nvim_buf_set_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                                std::vector<string> replacement) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_set_text", buffer, start_row, start_col, end_row,
+                                            end_col, replacement);
 }
 
-auto Api::nvim_call_function(string fn, std::vector<any> args) -> promise<any> {
-    co_return co_await rpc_->call("nvim_call_function", fn, args);
+auto Api::try_nvim_buf_set_var(integer buffer, string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_buf_set_var", buffer, name, value);
 }
 
-auto Api::nvim_chan_send(integer chan, string data) -> promise<void> {
-    co_await rpc_->call("nvim_chan_send", chan, data);
+auto Api::try_nvim_buf_set_virtual_text(integer buffer, integer src_id, integer line, std::vector<any> chunks,
+                                        table<string, any> opts) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_buf_set_virtual_text", buffer, src_id, line, chunks,
+                                               opts);
 }
 
-auto Api::nvim_clear_autocmds(table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_clear_autocmds", opts);
+auto Api::try_nvim_call_dict_function(any dict, string fn, std::vector<any> args) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_call_dict_function", dict, fn, args);
 }
 
-auto Api::nvim_cmd(table<string, any> cmd, table<string, any> opts) -> promise<string> {
-    auto response = co_await rpc_->call("nvim_cmd", cmd, opts);
-    co_return std::move(response.as_string());
+auto Api::try_nvim_call_function(string fn, std::vector<any> args) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_call_function", fn, args);
 }
 
-auto Api::nvim_command(string command) -> promise<void> {
-    co_await rpc_->call("nvim_command", command);
+auto Api::try_nvim_chan_send(integer chan, string data) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_chan_send", chan, data);
 }
 
-auto Api::nvim_command_output(string command) -> promise<string> {
-    auto response = co_await rpc_->call("nvim_command_output", command);
-    co_return std::move(response.as_string());
+auto Api::try_nvim_clear_autocmds(table<string, any> opts) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_clear_autocmds", opts);
 }
 
-auto Api::nvim_complete_set(integer index, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_complete_set", index, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_cmd(table<string, any> cmd, table<string, any> opts) -> promise<rpc::Result<string>> {
+    co_return co_await rpc_->try_call<string>(options(), "nvim_cmd", cmd, opts);
 }
 
-auto Api::nvim_create_augroup(string name, table<string, any> opts) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_create_augroup", name, opts);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_command(string command) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_command", command);
 }
 
-auto Api::nvim_create_autocmd(std::vector<std::string> event, table<any, any> opts) -> generator<any> {
-    const int id = next_notification_id();
+auto Api::try_nvim_command_output(string command) -> promise<rpc::Result<string>> {
+    co_return co_await rpc_->try_call<string>(options(), "nvim_command_output", command);
+}
 
-    // there is no easy way to handle callbacks via RPC, so wrap rpcnotify() call in a lua function
-    // use variant visitor to construct proper lua script
-    std::ostringstream event_stream;
-    boost::apply_visitor(LuaVisitor(event_stream), boost::variant<std::vector<std::string>>(std::move(event)));
+auto Api::try_nvim_complete_set(integer index, table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_complete_set", index, opts);
+}
 
-    // set callback explicitly to lua function
-    std::ostringstream opt_stream;
-    const auto body = fmt::format(R"(function(ev) vim.fn["rpcnotify"]({0}, '{1}', ev) end)", rpc_->channel(), id);
-    opts.emplace("callback", msgpack::type::raw_ref(body.data(), body.size()));
-    boost::apply_visitor(LuaVisitor(opt_stream), any(std::move(opts)));
+auto Api::try_nvim_create_augroup(string name, table<string, any> opts) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_create_augroup", name, opts);
+}
 
-    // register via lua API
-    const auto func = fmt::format(R"(lua vim.api.nvim_create_autocmd({0}, {1}))", event_stream.str(), opt_stream.str());
-    co_await rpc_->call("nvim_exec2", func, std::map<std::string, std::string>{});
+auto Api::try_nvim_create_buf(boolean listed, boolean scratch) -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_create_buf", listed, scratch);
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
+}
 
-    // wait for notifications with this id, return call arguments, which are going to be 'ev' dict from the callback
-    auto gen = rpc_->notifications(id);
-    while (gen) {
-        co_yield co_await gen;
-    }
-    co_return {};
+auto Api::try_nvim_create_namespace(string name) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_create_namespace", name);
 }
 
-auto Api::nvim_create_buf(boolean listed, boolean scratch) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_create_buf", listed, scratch);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_create_user_command(string name, any command, table<string, any> opts)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_create_user_command", name, command, opts);
 }
 
-auto Api::nvim_create_namespace(string name) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_create_namespace", name);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_del_augroup_by_id(integer id) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_augroup_by_id", id);
 }
 
-auto Api::nvim_create_user_command(string name, any command, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_create_user_command", name, command, opts);
+auto Api::try_nvim_del_augroup_by_name(string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_augroup_by_name", name);
 }
 
-auto Api::nvim_del_augroup_by_id(integer id) -> promise<void> {
-    co_await rpc_->call("nvim_del_augroup_by_id", id);
+auto Api::try_nvim_del_autocmd(integer id) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_autocmd", id);
 }
 
-auto Api::nvim_del_augroup_by_name(string name) -> promise<void> {
-    co_await rpc_->call("nvim_del_augroup_by_name", name);
+auto Api::try_nvim_del_current_line() -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_current_line");
 }
 
-auto Api::nvim_del_autocmd(integer id) -> promise<void> {
-    co_await rpc_->call("nvim_del_autocmd", id);
+auto Api::try_nvim_del_keymap(string mode, string lhs) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_keymap", mode, lhs);
 }
 
-auto Api::nvim_del_current_line() -> promise<void> {
-    co_await rpc_->call("nvim_del_current_line");
+auto Api::try_nvim_del_mark(string name) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_del_mark", name);
 }
 
-auto Api::nvim_del_keymap(string mode, string lhs) -> promise<void> {
-    co_await rpc_->call("nvim_del_keymap", mode, lhs);
+auto Api::try_nvim_del_user_command(string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_user_command", name);
 }
 
-auto Api::nvim_del_mark(string name) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_del_mark", name);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_del_var(string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_del_var", name);
 }
 
-auto Api::nvim_del_user_command(string name) -> promise<void> {
-    co_await rpc_->call("nvim_del_user_command", name);
+auto Api::try_nvim_echo(std::vector<any> chunks, boolean history, table<string, any> opts)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_echo", chunks, history, opts);
 }
 
-auto Api::nvim_del_var(string name) -> promise<void> {
-    co_await rpc_->call("nvim_del_var", name);
+auto Api::try_nvim_err_write(string str) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_err_write", str);
 }
 
-auto Api::nvim_echo(std::vector<any> chunks, boolean history, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_echo", chunks, history, opts);
+auto Api::try_nvim_err_writeln(string str) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_err_writeln", str);
 }
 
-auto Api::nvim_err_write(string str) -> promise<void> {
-    co_await rpc_->call("nvim_err_write", str);
+auto Api::try_nvim_eval(string expr) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_eval", expr);
 }
 
-auto Api::nvim_err_writeln(string str) -> promise<void> {
-    co_await rpc_->call("nvim_err_writeln", str);
+auto Api::try_nvim_eval_statusline(string str, table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_eval_statusline", str, opts);
 }
 
-auto Api::nvim_eval(string expr) -> promise<any> {
-    co_return co_await rpc_->call("nvim_eval", expr);
+auto Api::try_nvim_exec(string src, boolean output) -> promise<rpc::Result<string>> {
+    co_return co_await rpc_->try_call<string>(options(), "nvim_exec", src, output);
 }
 
-auto Api::nvim_eval_statusline(string str, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_eval_statusline", str, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_exec2(string src, table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_exec2", src, opts);
 }
 
-auto Api::nvim_exec(string src, boolean output) -> promise<string> {
-    auto response = co_await rpc_->call("nvim_exec", src, output);
-    co_return std::move(response.as_string());
+auto Api::try_nvim_exec2(string src, Exec2Opts opts) -> promise<rpc::Result<Exec2Result>> {
+    co_return co_await rpc_->try_call<Exec2Result>(options(), "nvim_exec2", src, opts);
 }
 
-auto Api::nvim_exec2(string src, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_exec2", src, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_exec_autocmds(any event, table<string, any> opts) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_exec_autocmds", event, opts);
 }
 
-auto Api::nvim_exec_autocmds(any event, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_exec_autocmds", event, opts);
+auto Api::try_nvim_feedkeys(string keys, string mode, boolean escape_ks) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_feedkeys", keys, mode, escape_ks);
 }
 
-auto Api::nvim_feedkeys(string keys, string mode, boolean escape_ks) -> promise<void> {
-    co_await rpc_->call("nvim_feedkeys", keys, mode, escape_ks);
+auto Api::try_nvim_get_all_options_info() -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_all_options_info");
 }
 
-auto Api::nvim_get_all_options_info() -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_all_options_info");
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_autocmds(table<string, any> opts) -> promise<rpc::Result<std::vector<any>>> {
+    co_return co_await rpc_->try_call<std::vector<any>>(options(), "nvim_get_autocmds", opts);
 }
 
-auto Api::nvim_get_autocmds(table<string, any> opts) -> promise<std::vector<any>> {
-    auto response = co_await rpc_->call("nvim_get_autocmds", opts);
-    co_return std::move(response.as_vector());
+auto Api::try_nvim_get_chan_info(integer chan) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_chan_info", chan);
 }
 
-auto Api::nvim_get_chan_info(integer chan) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_chan_info", chan);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_color_by_name(string name) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_get_color_by_name", name);
 }
 
-auto Api::nvim_get_color_by_name(string name) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_get_color_by_name", name);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_get_color_map() -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_color_map");
 }
 
-auto Api::nvim_get_color_map() -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_color_map");
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_commands(table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_commands", opts);
 }
 
-auto Api::nvim_get_commands(table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_commands", opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_context(table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_context", opts);
 }
 
-auto Api::nvim_get_context(table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_context", opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_current_buf() -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_get_current_buf");
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_get_current_buf() -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_get_current_buf");
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_get_current_line() -> promise<rpc::Result<string>> {
+    co_return co_await rpc_->try_call<string>(options(), "nvim_get_current_line");
 }
 
-auto Api::nvim_get_current_line() -> promise<string> {
-    auto response = co_await rpc_->call("nvim_get_current_line");
-    co_return std::move(response.as_string());
+auto Api::try_nvim_get_current_tabpage() -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_get_current_tabpage");
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_get_current_tabpage() -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_get_current_tabpage");
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_get_current_win() -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_get_current_win");
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_get_current_win() -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_get_current_win");
-    const auto ext = response.as_ext();
-    assert(ext.size() == sizeof(std::uint16_t) + 1);
-    char buf[2] = {ext.data()[2], ext.data()[1]};
-    co_return reinterpret_cast<const std::uint16_t&>(*buf);
+auto Api::try_nvim_get_hl(integer ns_id, table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_hl", ns_id, opts);
 }
 
-auto Api::nvim_get_hl(integer ns_id, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_hl", ns_id, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_hl_by_id(integer hl_id, boolean rgb) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_hl_by_id", hl_id, rgb);
 }
 
-auto Api::nvim_get_hl_by_id(integer hl_id, boolean rgb) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_hl_by_id", hl_id, rgb);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_hl_by_name(string name, boolean rgb) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_hl_by_name", name, rgb);
 }
 
-auto Api::nvim_get_hl_by_name(string name, boolean rgb) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_hl_by_name", name, rgb);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_hl_id_by_name(string name) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_get_hl_id_by_name", name);
 }
 
-auto Api::nvim_get_hl_id_by_name(string name) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_get_hl_id_by_name", name);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_get_hl_ns(table<string, any> opts) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_get_hl_ns", opts);
 }
 
-auto Api::nvim_get_hl_ns(table<string, any> opts) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_get_hl_ns", opts);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_get_keymap(string mode) -> promise<rpc::Result<std::vector<table<string, any>>>> {
+    co_return co_await rpc_->try_call<std::vector<table<string, any>>>(options(), "nvim_get_keymap", mode);
 }
 
-auto Api::nvim_get_keymap(string mode) -> promise<std::vector<table<string, any>>> {
-    auto response = co_await rpc_->call("nvim_get_keymap", mode);
-    std::vector<table<string, any>> result;
-    for (const auto& elem : response.as_vector()) {
-        table<string, any> res;
-        for (const auto& [k, v] : elem.as_multimap()) {
-            res.emplace(k.as_string(), v);
-        }
-        result.emplace_back(std::move(res));
-    }
-    co_return std::move(result);
+auto Api::try_nvim_get_mark(string name, table<string, any> opts) -> promise<rpc::Result<std::vector<any>>> {
+    co_return co_await rpc_->try_call<std::vector<any>>(options(), "nvim_get_mark", name, opts);
 }
 
-auto Api::nvim_get_mark(string name, table<string, any> opts) -> promise<std::vector<any>> {
-    auto response = co_await rpc_->call("nvim_get_mark", name, opts);
-    co_return std::move(response.as_vector());
+auto Api::try_nvim_get_mode() -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_mode");
 }
 
-auto Api::nvim_get_mode() -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_mode");
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_namespaces() -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_namespaces");
 }
 
-auto Api::nvim_get_namespaces() -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_namespaces");
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_option(string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_get_option", name);
 }
 
-auto Api::nvim_get_option(string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_get_option", name);
+auto Api::try_nvim_get_option_info(string name) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_option_info", name);
 }
 
-auto Api::nvim_get_option_info(string name) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_option_info", name);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_option_info2(string name, table<string, any> opts) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_get_option_info2", name, opts);
 }
 
-auto Api::nvim_get_option_info2(string name, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_get_option_info2", name, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_get_option_value(string name, table<string, any> opts) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_get_option_value", name, opts);
 }
 
-auto Api::nvim_get_option_value(string name, table<string, any> opts) -> promise<any> {
-    co_return co_await rpc_->call("nvim_get_option_value", name, opts);
+auto Api::try_nvim_get_proc(integer pid) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_get_proc", pid);
 }
 
-auto Api::nvim_get_proc(integer pid) -> promise<any> {
-    co_return co_await rpc_->call("nvim_get_proc", pid);
+auto Api::try_nvim_get_proc_children(integer pid) -> promise<rpc::Result<std::vector<any>>> {
+    co_return co_await rpc_->try_call<std::vector<any>>(options(), "nvim_get_proc_children", pid);
 }
 
-auto Api::nvim_get_proc_children(integer pid) -> promise<std::vector<any>> {
-    auto response = co_await rpc_->call("nvim_get_proc_children", pid);
-    co_return std::move(response.as_vector());
+auto Api::try_nvim_get_runtime_file(string name, boolean all) -> promise<rpc::Result<std::vector<string>>> {
+    co_return co_await rpc_->try_call<std::vector<string>>(options(), "nvim_get_runtime_file", name, all);
 }
 
-auto Api::nvim_get_runtime_file(string name, boolean all) -> promise<std::vector<string>> {
-    auto response = co_await rpc_->call("nvim_get_runtime_file", name, all);
-    co_return transform(response.as_vector(), [](auto t) -> string {
-        return t.as_string();
-    });
+auto Api::try_nvim_get_var(string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_get_var", name);
 }
 
-auto Api::nvim_get_var(string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_get_var", name);
+auto Api::try_nvim_get_vvar(string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_get_vvar", name);
 }
 
-auto Api::nvim_get_vvar(string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_get_vvar", name);
+auto Api::try_nvim_input(string keys) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_input", keys);
 }
 
-auto Api::nvim_input(string keys) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_input", keys);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_input_mouse(string button, string action, string modifier, integer grid, integer row, integer col)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_input_mouse", button, action, modifier, grid, row, col);
 }
 
-auto Api::nvim_input_mouse(string button, string action, string modifier, integer grid, integer row, integer col)
-    -> promise<void> {
-    co_await rpc_->call("nvim_input_mouse", button, action, modifier, grid, row, col);
+auto Api::try_nvim_list_bufs() -> promise<rpc::Result<std::vector<integer>>> {
+    const auto handles = co_await rpc_->try_call<std::vector<rpc::Handle>>(options(), "nvim_list_bufs");
+    if (!handles)
+        co_return std::unexpected(handles.error());
+    co_return std::vector<integer>(handles->begin(), handles->end());
 }
 
-auto Api::nvim_list_bufs() -> promise<std::vector<integer>> {
-    auto response = co_await rpc_->call("nvim_list_bufs");
-    co_return transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
+auto Api::try_nvim_list_chans() -> promise<rpc::Result<std::vector<any>>> {
+    co_return co_await rpc_->try_call<std::vector<any>>(options(), "nvim_list_chans");
 }
 
-auto Api::nvim_list_chans() -> promise<std::vector<any>> {
-    auto response = co_await rpc_->call("nvim_list_chans");
-    co_return std::move(response.as_vector());
+auto Api::try_nvim_list_runtime_paths() -> promise<rpc::Result<std::vector<string>>> {
+    co_return co_await rpc_->try_call<std::vector<string>>(options(), "nvim_list_runtime_paths");
 }
 
-auto Api::nvim_list_runtime_paths() -> promise<std::vector<string>> {
-    auto response = co_await rpc_->call("nvim_list_runtime_paths");
-    co_return transform(response.as_vector(), [](auto t) -> string {
-        return t.as_string();
-    });
+auto Api::try_nvim_list_tabpages() -> promise<rpc::Result<std::vector<integer>>> {
+    const auto handles = co_await rpc_->try_call<std::vector<rpc::Handle>>(options(), "nvim_list_tabpages");
+    if (!handles)
+        co_return std::unexpected(handles.error());
+    co_return std::vector<integer>(handles->begin(), handles->end());
 }
 
-auto Api::nvim_list_tabpages() -> promise<std::vector<integer>> {
-    auto response = co_await rpc_->call("nvim_list_tabpages");
-    co_return transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
+auto Api::try_nvim_list_uis() -> promise<rpc::Result<std::vector<any>>> {
+    co_return co_await rpc_->try_call<std::vector<any>>(options(), "nvim_list_uis");
 }
 
-auto Api::nvim_list_uis() -> promise<std::vector<any>> {
-    auto response = co_await rpc_->call("nvim_list_uis");
-    co_return std::move(response.as_vector());
+auto Api::try_nvim_list_wins() -> promise<rpc::Result<std::vector<integer>>> {
+    const auto handles = co_await rpc_->try_call<std::vector<rpc::Handle>>(options(), "nvim_list_wins");
+    if (!handles)
+        co_return std::unexpected(handles.error());
+    co_return std::vector<integer>(handles->begin(), handles->end());
 }
 
-auto Api::nvim_list_wins() -> promise<std::vector<integer>> {
-    auto response = co_await rpc_->call("nvim_list_wins");
-    co_return transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
+auto Api::try_nvim_load_context(table<string, any> dict) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_load_context", dict);
 }
 
-auto Api::nvim_load_context(table<string, any> dict) -> promise<any> {
-    co_return co_await rpc_->call("nvim_load_context", dict);
+auto Api::try_nvim_notify(string msg, integer log_level, table<string, any> opts) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_notify", msg, log_level, opts);
 }
 
-auto Api::nvim_notify(string msg, integer log_level, table<string, any> opts) -> promise<any> {
-    co_return co_await rpc_->call("nvim_notify", msg, log_level, opts);
+auto Api::try_nvim_open_term(integer buffer, table<string, any> opts) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_open_term", buffer, opts);
 }
 
-auto Api::nvim_open_term(integer buffer, table<string, any> opts) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_open_term", buffer, opts);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_open_win(integer buffer, boolean enter, table<string, any> config) -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_open_win", buffer, enter, config);
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_open_win(integer buffer, boolean enter, table<string, any> config) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_open_win", buffer, enter, config);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_out_write(string str) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_out_write", str);
 }
 
-auto Api::nvim_out_write(string str) -> promise<void> {
-    co_await rpc_->call("nvim_out_write", str);
+auto Api::try_nvim_parse_cmd(string str, table<string, any> opts) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_parse_cmd", str, opts);
 }
 
-auto Api::nvim_parse_cmd(string str, table<string, any> opts) -> promise<any> {
-    co_return co_await rpc_->call("nvim_parse_cmd", str, opts);
+auto Api::try_nvim_parse_expression(string expr, string flags, boolean highlight)
+    -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_parse_expression", expr, flags, highlight);
 }
 
-auto Api::nvim_parse_expression(string expr, string flags, boolean highlight) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_parse_expression", expr, flags, highlight);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_paste(string data, boolean crlf, integer phase) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_paste", data, crlf, phase);
 }
 
-auto Api::nvim_paste(string data, boolean crlf, integer phase) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_paste", data, crlf, phase);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_put(std::vector<string> lines, string type, boolean after, boolean follow)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_put", lines, type, after, follow);
 }
 
-auto Api::nvim_put(std::vector<string> lines, string type, boolean after, boolean follow) -> promise<void> {
-    co_await rpc_->call("nvim_put", lines, type, after, follow);
+auto Api::try_nvim_replace_termcodes(string str, boolean from_part, boolean do_lt, boolean special)
+    -> promise<rpc::Result<string>> {
+    co_return co_await rpc_->try_call<string>(options(), "nvim_replace_termcodes", str, from_part, do_lt, special);
 }
 
-auto Api::nvim_replace_termcodes(string str, boolean from_part, boolean do_lt, boolean special) -> promise<string> {
-    auto response = co_await rpc_->call("nvim_replace_termcodes", str, from_part, do_lt, special);
-    co_return std::move(response.as_string());
+auto Api::try_nvim_select_popupmenu_item(integer item, boolean insert, boolean finish, table<string, any> opts)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_select_popupmenu_item", item, insert, finish, opts);
 }
 
-auto Api::nvim_select_popupmenu_item(integer item, boolean insert, boolean finish, table<string, any> opts)
-    -> promise<void> {
-    co_await rpc_->call("nvim_select_popupmenu_item", item, insert, finish, opts);
+auto Api::try_nvim_set_current_buf(integer buffer) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_current_buf", buffer);
 }
 
-auto Api::nvim_set_current_buf(integer buffer) -> promise<void> {
-    co_await rpc_->call("nvim_set_current_buf", buffer);
+auto Api::try_nvim_set_current_dir(string dir) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_current_dir", dir);
 }
 
-auto Api::nvim_set_current_dir(string dir) -> promise<void> {
-    co_await rpc_->call("nvim_set_current_dir", dir);
+auto Api::try_nvim_set_current_line(string line) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_current_line", line);
 }
 
-auto Api::nvim_set_current_line(string line) -> promise<void> {
-    co_await rpc_->call("nvim_set_current_line", line);
+auto Api::try_nvim_set_current_tabpage(integer tabpage) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_current_tabpage", tabpage);
 }
 
-auto Api::nvim_set_current_tabpage(integer tabpage) -> promise<void> {
-    co_await rpc_->call("nvim_set_current_tabpage", tabpage);
+auto Api::try_nvim_set_current_win(integer window) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_current_win", window);
 }
 
-auto Api::nvim_set_current_win(integer window) -> promise<void> {
-    co_await rpc_->call("nvim_set_current_win", window);
+auto Api::try_nvim_set_decoration_provider(integer ns_id, table<string, any> opts) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_decoration_provider", ns_id, opts);
 }
 
-auto Api::nvim_set_decoration_provider(integer ns_id, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_set_decoration_provider", ns_id, opts);
+auto Api::try_nvim_set_hl(integer ns_id, string name, table<string, any> val) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_hl", ns_id, name, val);
 }
 
-auto Api::nvim_set_hl(integer ns_id, string name, table<string, any> val) -> promise<void> {
-    co_await rpc_->call("nvim_set_hl", ns_id, name, val);
+auto Api::try_nvim_set_hl_ns(integer ns_id) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_hl_ns", ns_id);
 }
 
-auto Api::nvim_set_hl_ns(integer ns_id) -> promise<void> {
-    co_await rpc_->call("nvim_set_hl_ns", ns_id);
+auto Api::try_nvim_set_hl_ns_fast(integer ns_id) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_hl_ns_fast", ns_id);
 }
 
-auto Api::nvim_set_hl_ns_fast(integer ns_id) -> promise<void> {
-    co_await rpc_->call("nvim_set_hl_ns_fast", ns_id);
+auto Api::try_nvim_set_keymap(string mode, string lhs, string rhs, table<string, any> opts)
+    -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_keymap", mode, lhs, rhs, opts);
 }
 
-auto Api::nvim_set_keymap(string mode, string lhs, string rhs, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_set_keymap", mode, lhs, rhs, opts);
+auto Api::try_nvim_set_option(string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_option", name, value);
 }
 
-auto Api::nvim_set_option(string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_set_option", name, value);
+auto Api::try_nvim_set_option_value(string name, any value, table<string, any> opts) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_option_value", name, value, opts);
 }
 
-auto Api::nvim_set_option_value(string name, any value, table<string, any> opts) -> promise<void> {
-    co_await rpc_->call("nvim_set_option_value", name, value, opts);
+auto Api::try_nvim_set_var(string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_var", name, value);
 }
 
-auto Api::nvim_set_var(string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_set_var", name, value);
+auto Api::try_nvim_set_vvar(string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_set_vvar", name, value);
 }
 
-auto Api::nvim_set_vvar(string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_set_vvar", name, value);
+auto Api::try_nvim_strwidth(string text) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_strwidth", text);
 }
 
-auto Api::nvim_strwidth(string text) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_strwidth", text);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_tabpage_del_var(integer tabpage, string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_tabpage_del_var", tabpage, name);
 }
 
-auto Api::nvim_tabpage_del_var(integer tabpage, string name) -> promise<void> {
-    co_await rpc_->call("nvim_tabpage_del_var", tabpage, name);
+auto Api::try_nvim_tabpage_get_number(integer tabpage) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_tabpage_get_number", tabpage);
 }
 
-auto Api::nvim_tabpage_get_number(integer tabpage) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_tabpage_get_number", tabpage);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_tabpage_get_var(integer tabpage, string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_tabpage_get_var", tabpage, name);
 }
 
-auto Api::nvim_tabpage_get_var(integer tabpage, string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_tabpage_get_var", tabpage, name);
+auto Api::try_nvim_tabpage_get_win(integer tabpage) -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_tabpage_get_win", tabpage);
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_tabpage_get_win(integer tabpage) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_tabpage_get_win", tabpage);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_tabpage_is_valid(integer tabpage) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_tabpage_is_valid", tabpage);
 }
 
-auto Api::nvim_tabpage_is_valid(integer tabpage) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_tabpage_is_valid", tabpage);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_tabpage_list_wins(integer tabpage) -> promise<rpc::Result<std::vector<integer>>> {
+    const auto handles = co_await rpc_->try_call<std::vector<rpc::Handle>>(options(), "nvim_tabpage_list_wins",
+                                                                           tabpage);
+    if (!handles)
+        co_return std::unexpected(handles.error());
+    co_return std::vector<integer>(handles->begin(), handles->end());
 }
 
-auto Api::nvim_tabpage_list_wins(integer tabpage) -> promise<std::vector<integer>> {
-    auto response = co_await rpc_->call("nvim_tabpage_list_wins", tabpage);
-    co_return transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
+auto Api::try_nvim_tabpage_set_var(integer tabpage, string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_tabpage_set_var", tabpage, name, value);
 }
 
-auto Api::nvim_tabpage_set_var(integer tabpage, string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_tabpage_set_var", tabpage, name, value);
+auto Api::try_nvim_tabpage_set_win(integer tabpage, integer win) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_tabpage_set_win", tabpage, win);
 }
 
-auto Api::nvim_tabpage_set_win(integer tabpage, integer win) -> promise<void> {
-    co_await rpc_->call("nvim_tabpage_set_win", tabpage, win);
+auto Api::try_nvim_win_call(integer window, function) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_win_call", window);
 }
 
-auto Api::nvim_win_call(integer window, function) -> promise<any> {
-    co_return co_await rpc_->call("nvim_win_call", window);
+auto Api::try_nvim_win_close(integer window, boolean force) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_close", window, force);
 }
 
-auto Api::nvim_win_close(integer window, boolean force) -> promise<void> {
-    co_await rpc_->call("nvim_win_close", window, force);
+auto Api::try_nvim_win_del_var(integer window, string name) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_del_var", window, name);
 }
 
-auto Api::nvim_win_del_var(integer window, string name) -> promise<void> {
-    co_await rpc_->call("nvim_win_del_var", window, name);
+auto Api::try_nvim_win_get_buf(integer window) -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_win_get_buf", window);
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_win_get_buf(integer window) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_win_get_buf", window);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_win_get_config(integer window) -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_win_get_config", window);
 }
 
-auto Api::nvim_win_get_config(integer window) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_win_get_config", window);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::try_nvim_win_get_cursor(integer window) -> promise<rpc::Result<std::vector<integer>>> {
+    co_return co_await rpc_->try_call<std::vector<integer>>(options(), "nvim_win_get_cursor", window);
 }
 
-auto Api::nvim_win_get_cursor(integer window) -> promise<std::vector<integer>> {
-    auto response = co_await rpc_->call("nvim_win_get_cursor", window);
-    co_return transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
+auto Api::try_nvim_win_get_height(integer window) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_win_get_height", window);
 }
 
-auto Api::nvim_win_get_height(integer window) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_win_get_height", window);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_win_get_number(integer window) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_win_get_number", window);
 }
 
-auto Api::nvim_win_get_number(integer window) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_win_get_number", window);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_win_get_option(integer window, string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_win_get_option", window, name);
 }
 
-auto Api::nvim_win_get_option(integer window, string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_win_get_option", window, name);
+auto Api::try_nvim_win_get_position(integer window) -> promise<rpc::Result<Point>> {
+    const auto position = co_await rpc_->try_call<std::array<integer, 2>>(options(), "nvim_win_get_position", window);
+    if (!position)
+        co_return std::unexpected(position.error());
+    co_return Point{.x = (*position)[1], .y = (*position)[0]};
 }
 
-auto Api::nvim_win_get_position(integer window) -> promise<Point> {
-    auto response = co_await rpc_->call("nvim_win_get_position", window);
-    const auto vec = transform(response.as_vector(), [](auto t) -> integer {
-        return t.as_uint64_t();
-    });
-    co_return Point{.x = vec.back(), .y = vec.front()};
+auto Api::try_nvim_win_get_tabpage(integer window) -> promise<rpc::Result<integer>> {
+    const auto handle = co_await rpc_->try_call<rpc::Handle>(options(), "nvim_win_get_tabpage", window);
+    if (!handle)
+        co_return std::unexpected(handle.error());
+    co_return handle->id;
 }
 
-auto Api::nvim_win_get_tabpage(integer window) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_win_get_tabpage", window);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_win_get_var(integer window, string name) -> promise<rpc::Result<any>> {
+    co_return co_await rpc_->try_call<any>(options(), "nvim_win_get_var", window, name);
 }
 
-auto Api::nvim_win_get_var(integer window, string name) -> promise<any> {
-    co_return co_await rpc_->call("nvim_win_get_var", window, name);
+auto Api::try_nvim_win_get_width(integer window) -> promise<rpc::Result<integer>> {
+    co_return co_await rpc_->try_call<integer>(options(), "nvim_win_get_width", window);
 }
 
-auto Api::nvim_win_get_width(integer window) -> promise<integer> {
-    auto response = co_await rpc_->call("nvim_win_get_width", window);
-    co_return std::move(response.as_uint64_t());
+auto Api::try_nvim_win_hide(integer window) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_hide", window);
 }
 
-auto Api::nvim_win_hide(integer window) -> promise<void> {
-    co_await rpc_->call("nvim_win_hide", window);
+auto Api::try_nvim_win_is_valid(integer window) -> promise<rpc::Result<boolean>> {
+    co_return co_await rpc_->try_call<boolean>(options(), "nvim_win_is_valid", window);
 }
 
-auto Api::nvim_win_is_valid(integer window) -> promise<boolean> {
-    auto response = co_await rpc_->call("nvim_win_is_valid", window);
-    co_return std::move(response.as_bool());
+auto Api::try_nvim_win_set_buf(integer window, integer buffer) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_buf", window, buffer);
 }
 
-auto Api::nvim_win_set_buf(integer window, integer buffer) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_buf", window, buffer);
+auto Api::try_nvim_win_set_config(integer window, table<string, any> config) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_config", window, config);
 }
 
-auto Api::nvim_win_set_config(integer window, table<string, any> config) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_config", window, config);
+auto Api::try_nvim_win_set_cursor(integer window, std::vector<integer> pos) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_cursor", window, pos);
 }
 
-auto Api::nvim_win_set_cursor(integer window, std::vector<integer> pos) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_cursor", window, pos);
+auto Api::try_nvim_win_set_height(integer window, integer height) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_height", window, height);
 }
 
-auto Api::nvim_win_set_height(integer window, integer height) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_height", window, height);
+auto Api::try_nvim_win_set_hl_ns(integer window, integer ns_id) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_hl_ns", window, ns_id);
 }
 
-auto Api::nvim_win_set_hl_ns(integer window, integer ns_id) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_hl_ns", window, ns_id);
+auto Api::try_nvim_win_set_option(integer window, string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_option", window, name, value);
 }
 
-auto Api::nvim_win_set_option(integer window, string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_option", window, name, value);
+auto Api::try_nvim_win_set_var(integer window, string name, any value) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_var", window, name, value);
 }
 
-auto Api::nvim_win_set_var(integer window, string name, any value) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_var", window, name, value);
+auto Api::try_nvim_win_set_width(integer window, integer width) -> promise<rpc::Result<void>> {
+    co_return co_await rpc_->try_call<void>(options(), "nvim_win_set_width", window, width);
 }
 
-auto Api::nvim_win_set_width(integer window, integer width) -> promise<void> {
-    co_await rpc_->call("nvim_win_set_width", window, width);
+auto Api::try_nvim_win_text_height(integer window, table<string, any> opts)
+    -> promise<rpc::Result<table<string, any>>> {
+    co_return co_await rpc_->try_call<table<string, any>>(options(), "nvim_win_text_height", window, opts);
 }
 
-auto Api::nvim_win_text_height(integer window, table<string, any> opts) -> promise<table<string, any>> {
-    auto response = co_await rpc_->call("nvim_win_text_height", window, opts);
-    table<string, any> res;
-    for (const auto& [k, v] : response.as_multimap()) {
-        res.emplace(k.as_string(), v);
-    }
-    co_return res;
+auto Api::nvim_buf_add_highlight(integer buffer, integer ns_id, string hl_group, integer line, integer col_start,
+                                 integer col_end) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_add_highlight", buffer, ns_id, hl_group, line,
+                                           col_start, col_end);
+}
+
+auto Api::nvim_buf_attach(integer buffer, boolean send_buffer, table<string, any> opts) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_buf_attach", buffer, send_buffer, opts);
+}
+
+auto Api::nvim_buf_call(integer buffer, function) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_buf_call", buffer);
+}
+
+auto Api::nvim_buf_clear_highlight(integer buffer, integer ns_id, integer line_start, integer line_end)
+    -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_clear_highlight", buffer, ns_id, line_start, line_end);
+}
+
+auto Api::nvim_buf_clear_namespace(integer buffer, integer ns_id, integer line_start, integer line_end)
+    -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_clear_namespace", buffer, ns_id, line_start, line_end);
+}
+
+auto Api::nvim_buf_create_user_command(integer buffer, string name, any command, table<string, any> opts)
+    -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_create_user_command", buffer, name, command, opts);
+}
+
+auto Api::nvim_buf_del_extmark(integer buffer, integer ns_id, integer id) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_buf_del_extmark", buffer, ns_id, id);
+}
+
+auto Api::nvim_buf_del_keymap(integer buffer, string mode, string lhs) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_del_keymap", buffer, mode, lhs);
+}
+
+auto Api::nvim_buf_del_mark(integer buffer, string name) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_buf_del_mark", buffer, name);
+}
+
+auto Api::nvim_buf_del_user_command(integer buffer, string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_del_user_command", buffer, name);
+}
+
+auto Api::nvim_buf_del_var(integer buffer, string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_del_var", buffer, name);
+}
+
+auto Api::nvim_buf_delete(integer buffer, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_delete", buffer, opts);
+}
+
+auto Api::nvim_buf_get_changedtick(integer buffer) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_get_changedtick", buffer);
+}
+
+auto Api::nvim_buf_get_commands(integer buffer, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_buf_get_commands", buffer, opts);
+}
+
+auto Api::nvim_buf_get_extmark_by_id(integer buffer, integer ns_id, integer id, table<string, any> opts)
+    -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_buf_get_extmark_by_id", buffer, ns_id, id, opts);
+}
+
+auto Api::nvim_buf_get_extmarks(integer buffer, integer ns_id, any start, any end_, table<string, any> opts)
+    -> promise<std::vector<any>> {
+    co_return co_await rpc_->call<std::vector<any>>(options(), "nvim_buf_get_extmarks", buffer, ns_id, start, end_,
+                                                    opts);
+}
+
+auto Api::nvim_buf_get_keymap(integer buffer, string mode) -> promise<std::vector<table<string, any>>> {
+    co_return co_await rpc_->call<std::vector<table<string, any>>>(options(), "nvim_buf_get_keymap", buffer, mode);
+}
+
+auto Api::nvim_buf_get_lines(integer buffer, integer start, integer end_, boolean strict_indexing)
+    -> promise<std::vector<string>> {
+    co_return co_await rpc_->call<std::vector<string>>(options(), "nvim_buf_get_lines", buffer, start, end_,
+                                                       strict_indexing);
+}
+
+auto Api::nvim_buf_get_mark(integer buffer, string name) -> promise<std::vector<integer>> {
+    co_return co_await rpc_->call<std::vector<integer>>(options(), "nvim_buf_get_mark", buffer, name);
+}
+
+auto Api::nvim_buf_get_name(integer buffer) -> promise<string> {
+    co_return co_await rpc_->call<string>(options(), "nvim_buf_get_name", buffer);
+}
+
+auto Api::nvim_buf_get_number(integer buffer) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_get_number", buffer);
+}
+
+auto Api::nvim_buf_get_offset(integer buffer, integer index) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_get_offset", buffer, index);
+}
+
+auto Api::nvim_buf_get_option(integer buffer, string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_buf_get_option", buffer, name);
+}
+
+auto Api::nvim_buf_get_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                            table<string, any> opts) -> promise<std::vector<string>> {
+    co_return co_await rpc_->call<std::vector<string>>(options(), "nvim_buf_get_text", buffer, start_row, start_col,
+                                                       end_row, end_col, opts);
+}
+
+auto Api::nvim_buf_get_var(integer buffer, string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_buf_get_var", buffer, name);
+}
+
+auto Api::nvim_buf_is_loaded(integer buffer) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_buf_is_loaded", buffer);
+}
+
+auto Api::nvim_buf_is_valid(integer buffer) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_buf_is_valid", buffer);
+}
+
+auto Api::nvim_buf_line_count(integer buffer) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_line_count", buffer);
+}
+
+auto Api::nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
+    -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
+}
+
+auto Api::nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, ExtmarkOpts opts)
+    -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
+}
+
+auto Api::nvim_buf_set_keymap(integer buffer, string mode, string lhs, string rhs, table<string, any> opts)
+    -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_set_keymap", buffer, mode, lhs, rhs, opts);
+}
+
+auto Api::nvim_buf_set_lines(integer buffer, integer start, integer end_, boolean strict_indexing,
+                             std::vector<string> replacement) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_set_lines", buffer, start, end_, strict_indexing, replacement);
+}
+
+auto Api::nvim_buf_set_mark(integer buffer, string name, integer line, integer col, table<string, any> opts)
+    -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_buf_set_mark", buffer, name, line, col, opts);
+}
+
+auto Api::nvim_buf_set_name(integer buffer, string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_set_name", buffer, name);
+}
+
+auto Api::nvim_buf_set_option(integer buffer, string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_set_option", buffer, name, value);
+}
+
+auto Api::nvim_buf_set_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                            std::vector<string> replacement) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_set_text", buffer, start_row, start_col, end_row, end_col,
+                              replacement);
+}
+
+auto Api::nvim_buf_set_var(integer buffer, string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_buf_set_var", buffer, name, value);
+}
+
+auto Api::nvim_buf_set_virtual_text(integer buffer, integer src_id, integer line, std::vector<any> chunks,
+                                    table<string, any> opts) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_buf_set_virtual_text", buffer, src_id, line, chunks, opts);
+}
+
+auto Api::nvim_call_dict_function(any dict, string fn, std::vector<any> args) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_call_dict_function", dict, fn, args);
+}
+
+auto Api::nvim_call_function(string fn, std::vector<any> args) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_call_function", fn, args);
+}
+
+auto Api::nvim_chan_send(integer chan, string data) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_chan_send", chan, data);
+}
+
+auto Api::nvim_clear_autocmds(table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_clear_autocmds", opts);
+}
+
+auto Api::nvim_cmd(table<string, any> cmd, table<string, any> opts) -> promise<string> {
+    co_return co_await rpc_->call<string>(options(), "nvim_cmd", cmd, opts);
+}
+
+auto Api::nvim_command(string command) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_command", command);
+}
+
+auto Api::nvim_command_output(string command) -> promise<string> {
+    co_return co_await rpc_->call<string>(options(), "nvim_command_output", command);
+}
+
+auto Api::nvim_complete_set(integer index, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_complete_set", index, opts);
+}
+
+template <typename T, typename... Args>
+auto Api::call_helper(const char* name, Args... args) -> promise<T> {
+    if constexpr (std::is_void_v<T>) {
+        co_await rpc_->call<void>(options(), "nvim_exec_lua", call_helper_lua, std::make_tuple(name, args...));
+    } else {
+        // results of helpers are cached under their names, e.g. `visible_lines`
+        auto options = this->options();
+        options.cache_as = name;
+        co_return co_await rpc_->call<T>(options, "nvim_exec_lua", call_helper_lua, std::make_tuple(name, args...));
+    }
+}
+
+auto Api::allow_buffer(string allowlist, integer buffer, boolean allowed) -> promise<void> {
+    co_await call_helper<void>("allow_buffer", std::move(allowlist), buffer, allowed);
+}
+
+auto Api::visible_lines(integer window) -> promise<VisibleLines> {
+    co_return co_await call_helper<VisibleLines>("visible_lines", window);
+}
+
+auto Api::terminal_query(string query, string reply, std::chrono::milliseconds timeout) -> promise<string> {
+    const auto id = next_notification_id();
+    auto response = notification(id);
+    co_await call_helper<void>("terminal_query", rpc_channel(), std::to_string(id), std::move(query),
+                               std::move(reply), static_cast<integer>(timeout.count()));
+    const auto res = co_await response;
+    co_return res[0].as<string>();
+}
+
+auto Api::window_origin(integer window, boolean offsets_only) -> promise<WindowOrigin> {
+    co_return co_await call_helper<WindowOrigin>("window_origin", window, offsets_only);
+}
+
+auto Api::nvim_pid() -> promise<integer> {
+    co_return co_await call_helper<integer>("getpid");
+}
+
+auto Api::nvim_create_augroup(string name, table<string, any> opts) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_create_augroup", name, opts);
+}
+
+template <typename Opts>
+auto Api::create_autocmd(std::vector<std::string> event, Opts opts, EventFilter filter,
+                         rpc::SubscriptionOptions subscription) -> generator<view> {
+    const int id = next_notification_id();
+
+    // subscribe first, the autocmd may fire before the registration call returns,
+    // both on the interactive lane, its channel is the one the callback notifies
+    const auto& rpc = lanes_->interactive;
+    auto gen = rpc->notifications(id, std::move(subscription));
+    co_await rpc->call<void>(
+        "nvim_exec_lua", call_helper_lua,
+        std::make_tuple("create_autocmd", rpc->channel(), std::to_string(id), event, opts, filter));
+
+    // notifications with this id carry the 'ev' dict of the callback
+    while (gen) {
+        co_yield co_await gen;
+    }
+    co_return {};
+}
+
+auto Api::nvim_create_autocmd(std::vector<std::string> event, table<any, any> opts,
+                              rpc::SubscriptionOptions subscription) -> generator<view> {
+    return create_autocmd(std::move(event), std::move(opts), EventFilter{}, std::move(subscription));
+}
+
+auto Api::nvim_create_autocmd(std::vector<std::string> event, AutocmdOpts opts, rpc::SubscriptionOptions subscription)
+    -> generator<view> {
+    return create_autocmd(std::move(event), std::move(opts), EventFilter{}, std::move(subscription));
+}
+
+auto Api::nvim_create_autocmd(std::vector<std::string> event, AutocmdOpts opts, EventFilter filter,
+                              rpc::SubscriptionOptions subscription) -> generator<view> {
+    return create_autocmd(std::move(event), std::move(opts), std::move(filter), std::move(subscription));
+}
+
+auto Api::nvim_create_buf(boolean listed, boolean scratch) -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_create_buf", listed, scratch);
+    co_return handle.id;
+}
+
+auto Api::nvim_create_namespace(string name) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_create_namespace", name);
+}
+
+auto Api::nvim_create_user_command(string name, any command, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_create_user_command", name, command, opts);
+}
+
+auto Api::nvim_del_augroup_by_id(integer id) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_augroup_by_id", id);
+}
+
+auto Api::nvim_del_augroup_by_name(string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_augroup_by_name", name);
+}
+
+auto Api::nvim_del_autocmd(integer id) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_autocmd", id);
+}
+
+auto Api::nvim_del_current_line() -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_current_line");
+}
+
+auto Api::nvim_del_keymap(string mode, string lhs) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_keymap", mode, lhs);
+}
+
+auto Api::nvim_del_mark(string name) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_del_mark", name);
+}
+
+auto Api::nvim_del_user_command(string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_user_command", name);
+}
+
+auto Api::nvim_del_var(string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_del_var", name);
+}
+
+auto Api::nvim_echo(std::vector<any> chunks, boolean history, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_echo", chunks, history, opts);
+}
+
+auto Api::nvim_err_write(string str) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_err_write", str);
+}
+
+auto Api::nvim_err_writeln(string str) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_err_writeln", str);
+}
+
+auto Api::nvim_eval(string expr) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_eval", expr);
+}
+
+auto Api::nvim_eval_statusline(string str, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_eval_statusline", str, opts);
+}
+
+auto Api::nvim_exec(string src, boolean output) -> promise<string> {
+    co_return co_await rpc_->call<string>(options(), "nvim_exec", src, output);
+}
+
+auto Api::nvim_exec2(string src, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_exec2", src, opts);
+}
+
+auto Api::nvim_exec2(string src, Exec2Opts opts) -> promise<Exec2Result> {
+    co_return co_await rpc_->call<Exec2Result>(options(), "nvim_exec2", src, opts);
+}
+
+auto Api::nvim_exec_autocmds(any event, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_exec_autocmds", event, opts);
+}
+
+auto Api::nvim_feedkeys(string keys, string mode, boolean escape_ks) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_feedkeys", keys, mode, escape_ks);
+}
+
+auto Api::nvim_get_all_options_info() -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_all_options_info");
+}
+
+auto Api::nvim_get_autocmds(table<string, any> opts) -> promise<std::vector<any>> {
+    co_return co_await rpc_->call<std::vector<any>>(options(), "nvim_get_autocmds", opts);
+}
+
+auto Api::nvim_get_chan_info(integer chan) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_chan_info", chan);
+}
+
+auto Api::nvim_get_color_by_name(string name) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_get_color_by_name", name);
+}
+
+auto Api::nvim_get_color_map() -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_color_map");
+}
+
+auto Api::nvim_get_commands(table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_commands", opts);
+}
+
+auto Api::nvim_get_context(table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_context", opts);
+}
+
+auto Api::nvim_get_current_buf() -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_get_current_buf");
+    co_return handle.id;
+}
+
+auto Api::nvim_get_current_line() -> promise<string> {
+    co_return co_await rpc_->call<string>(options(), "nvim_get_current_line");
+}
+
+auto Api::nvim_get_current_tabpage() -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_get_current_tabpage");
+    co_return handle.id;
+}
+
+auto Api::nvim_get_current_win() -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_get_current_win");
+    co_return handle.id;
+}
+
+auto Api::nvim_get_hl(integer ns_id, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_hl", ns_id, opts);
+}
+
+auto Api::nvim_get_hl_by_id(integer hl_id, boolean rgb) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_hl_by_id", hl_id, rgb);
+}
+
+auto Api::nvim_get_hl_by_name(string name, boolean rgb) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_hl_by_name", name, rgb);
+}
+
+auto Api::nvim_get_hl_id_by_name(string name) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_get_hl_id_by_name", name);
+}
+
+auto Api::nvim_get_hl_ns(table<string, any> opts) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_get_hl_ns", opts);
+}
+
+auto Api::nvim_get_keymap(string mode) -> promise<std::vector<table<string, any>>> {
+    co_return co_await rpc_->call<std::vector<table<string, any>>>(options(), "nvim_get_keymap", mode);
+}
+
+auto Api::nvim_get_mark(string name, table<string, any> opts) -> promise<std::vector<any>> {
+    co_return co_await rpc_->call<std::vector<any>>(options(), "nvim_get_mark", name, opts);
+}
+
+auto Api::nvim_get_mode() -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_mode");
+}
+
+auto Api::nvim_get_namespaces() -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_namespaces");
+}
+
+auto Api::nvim_get_option(string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_get_option", name);
+}
+
+auto Api::nvim_get_option_info(string name) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_option_info", name);
+}
+
+auto Api::nvim_get_option_info2(string name, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_get_option_info2", name, opts);
+}
+
+auto Api::nvim_get_option_value(string name, table<string, any> opts) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_get_option_value", name, opts);
+}
+
+auto Api::nvim_get_proc(integer pid) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_get_proc", pid);
+}
+
+auto Api::nvim_get_proc_children(integer pid) -> promise<std::vector<any>> {
+    co_return co_await rpc_->call<std::vector<any>>(options(), "nvim_get_proc_children", pid);
+}
+
+auto Api::nvim_get_runtime_file(string name, boolean all) -> promise<std::vector<string>> {
+    co_return co_await rpc_->call<std::vector<string>>(options(), "nvim_get_runtime_file", name, all);
+}
+
+auto Api::nvim_get_var(string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_get_var", name);
+}
+
+auto Api::nvim_get_vvar(string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_get_vvar", name);
+}
+
+auto Api::nvim_input(string keys) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_input", keys);
+}
+
+auto Api::nvim_input_mouse(string button, string action, string modifier, integer grid, integer row, integer col)
+    -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_input_mouse", button, action, modifier, grid, row, col);
+}
+
+auto Api::nvim_list_bufs() -> promise<std::vector<integer>> {
+    const auto handles = co_await rpc_->call<std::vector<rpc::Handle>>(options(), "nvim_list_bufs");
+    co_return std::vector<integer>(handles.begin(), handles.end());
+}
+
+auto Api::nvim_list_chans() -> promise<std::vector<any>> {
+    co_return co_await rpc_->call<std::vector<any>>(options(), "nvim_list_chans");
+}
+
+auto Api::nvim_list_runtime_paths() -> promise<std::vector<string>> {
+    co_return co_await rpc_->call<std::vector<string>>(options(), "nvim_list_runtime_paths");
+}
+
+auto Api::nvim_list_tabpages() -> promise<std::vector<integer>> {
+    const auto handles = co_await rpc_->call<std::vector<rpc::Handle>>(options(), "nvim_list_tabpages");
+    co_return std::vector<integer>(handles.begin(), handles.end());
+}
+
+auto Api::nvim_list_uis() -> promise<std::vector<any>> {
+    co_return co_await rpc_->call<std::vector<any>>(options(), "nvim_list_uis");
+}
+
+auto Api::nvim_list_wins() -> promise<std::vector<integer>> {
+    const auto handles = co_await rpc_->call<std::vector<rpc::Handle>>(options(), "nvim_list_wins");
+    co_return std::vector<integer>(handles.begin(), handles.end());
+}
+
+auto Api::nvim_load_context(table<string, any> dict) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_load_context", dict);
+}
+
+auto Api::nvim_notify(string msg, integer log_level, table<string, any> opts) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_notify", msg, log_level, opts);
+}
+
+auto Api::nvim_open_term(integer buffer, table<string, any> opts) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_open_term", buffer, opts);
+}
+
+auto Api::nvim_open_win(integer buffer, boolean enter, table<string, any> config) -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_open_win", buffer, enter, config);
+    co_return handle.id;
+}
+
+auto Api::nvim_out_write(string str) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_out_write", str);
+}
+
+auto Api::nvim_parse_cmd(string str, table<string, any> opts) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_parse_cmd", str, opts);
+}
+
+auto Api::nvim_parse_expression(string expr, string flags, boolean highlight) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_parse_expression", expr, flags, highlight);
+}
+
+auto Api::nvim_paste(string data, boolean crlf, integer phase) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_paste", data, crlf, phase);
+}
+
+auto Api::nvim_put(std::vector<string> lines, string type, boolean after, boolean follow) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_put", lines, type, after, follow);
+}
+
+auto Api::nvim_replace_termcodes(string str, boolean from_part, boolean do_lt, boolean special) -> promise<string> {
+    co_return co_await rpc_->call<string>(options(), "nvim_replace_termcodes", str, from_part, do_lt, special);
+}
+
+auto Api::nvim_select_popupmenu_item(integer item, boolean insert, boolean finish, table<string, any> opts)
+    -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_select_popupmenu_item", item, insert, finish, opts);
+}
+
+auto Api::nvim_set_current_buf(integer buffer) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_current_buf", buffer);
+}
+
+auto Api::nvim_set_current_dir(string dir) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_current_dir", dir);
+}
+
+auto Api::nvim_set_current_line(string line) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_current_line", line);
+}
+
+auto Api::nvim_set_current_tabpage(integer tabpage) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_current_tabpage", tabpage);
+}
+
+auto Api::nvim_set_current_win(integer window) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_current_win", window);
+}
+
+auto Api::nvim_set_decoration_provider(integer ns_id, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_decoration_provider", ns_id, opts);
+}
+
+auto Api::nvim_set_hl(integer ns_id, string name, table<string, any> val) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_hl", ns_id, name, val);
+}
+
+auto Api::nvim_set_hl_ns(integer ns_id) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_hl_ns", ns_id);
+}
+
+auto Api::nvim_set_hl_ns_fast(integer ns_id) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_hl_ns_fast", ns_id);
+}
+
+auto Api::nvim_set_keymap(string mode, string lhs, string rhs, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_keymap", mode, lhs, rhs, opts);
+}
+
+auto Api::nvim_set_option(string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_option", name, value);
+}
+
+auto Api::nvim_set_option_value(string name, any value, table<string, any> opts) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_option_value", name, value, opts);
+}
+
+auto Api::nvim_set_var(string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_var", name, value);
+}
+
+auto Api::nvim_set_vvar(string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_set_vvar", name, value);
+}
+
+auto Api::nvim_strwidth(string text) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_strwidth", text);
+}
+
+auto Api::nvim_tabpage_del_var(integer tabpage, string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_tabpage_del_var", tabpage, name);
+}
+
+auto Api::nvim_tabpage_get_number(integer tabpage) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_tabpage_get_number", tabpage);
+}
+
+auto Api::nvim_tabpage_get_var(integer tabpage, string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_tabpage_get_var", tabpage, name);
+}
+
+auto Api::nvim_tabpage_get_win(integer tabpage) -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_tabpage_get_win", tabpage);
+    co_return handle.id;
+}
+
+auto Api::nvim_tabpage_is_valid(integer tabpage) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_tabpage_is_valid", tabpage);
+}
+
+auto Api::nvim_tabpage_list_wins(integer tabpage) -> promise<std::vector<integer>> {
+    const auto handles = co_await rpc_->call<std::vector<rpc::Handle>>(options(), "nvim_tabpage_list_wins", tabpage);
+    co_return std::vector<integer>(handles.begin(), handles.end());
+}
+
+auto Api::nvim_tabpage_set_var(integer tabpage, string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_tabpage_set_var", tabpage, name, value);
+}
+
+auto Api::nvim_tabpage_set_win(integer tabpage, integer win) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_tabpage_set_win", tabpage, win);
+}
+
+auto Api::nvim_win_call(integer window, function) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_win_call", window);
+}
+
+auto Api::nvim_win_close(integer window, boolean force) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_close", window, force);
+}
+
+auto Api::nvim_win_del_var(integer window, string name) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_del_var", window, name);
+}
+
+auto Api::nvim_win_get_buf(integer window) -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_win_get_buf", window);
+    co_return handle.id;
+}
+
+auto Api::nvim_win_get_config(integer window) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_win_get_config", window);
+}
+
+auto Api::nvim_win_get_cursor(integer window) -> promise<std::vector<integer>> {
+    co_return co_await rpc_->call<std::vector<integer>>(options(), "nvim_win_get_cursor", window);
+}
+
+auto Api::nvim_win_get_height(integer window) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_win_get_height", window);
+}
+
+auto Api::nvim_win_get_number(integer window) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_win_get_number", window);
+}
+
+auto Api::nvim_win_get_option(integer window, string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_win_get_option", window, name);
+}
+
+auto Api::nvim_win_get_position(integer window) -> promise<Point> {
+    const auto [row, col] = co_await rpc_->call<std::array<integer, 2>>(options(), "nvim_win_get_position", window);
+    co_return Point{.x = col, .y = row};
+}
+
+auto Api::nvim_win_get_tabpage(integer window) -> promise<integer> {
+    const auto handle = co_await rpc_->call<rpc::Handle>(options(), "nvim_win_get_tabpage", window);
+    co_return handle.id;
+}
+
+auto Api::nvim_win_get_var(integer window, string name) -> promise<any> {
+    co_return co_await rpc_->call<any>(options(), "nvim_win_get_var", window, name);
+}
+
+auto Api::nvim_win_get_width(integer window) -> promise<integer> {
+    co_return co_await rpc_->call<integer>(options(), "nvim_win_get_width", window);
+}
+
+auto Api::nvim_win_hide(integer window) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_hide", window);
+}
+
+auto Api::nvim_win_is_valid(integer window) -> promise<boolean> {
+    co_return co_await rpc_->call<boolean>(options(), "nvim_win_is_valid", window);
+}
+
+auto Api::nvim_win_set_buf(integer window, integer buffer) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_buf", window, buffer);
+}
+
+auto Api::nvim_win_set_config(integer window, table<string, any> config) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_config", window, config);
+}
+
+auto Api::nvim_win_set_cursor(integer window, std::vector<integer> pos) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_cursor", window, pos);
+}
+
+auto Api::nvim_win_set_height(integer window, integer height) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_height", window, height);
+}
+
+auto Api::nvim_win_set_hl_ns(integer window, integer ns_id) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_hl_ns", window, ns_id);
+}
+
+auto Api::nvim_win_set_option(integer window, string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_option", window, name, value);
+}
+
+auto Api::nvim_win_set_var(integer window, string name, any value) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_var", window, name, value);
+}
+
+auto Api::nvim_win_set_width(integer window, integer width) -> promise<void> {
+    co_await rpc_->call<void>(options(), "nvim_win_set_width", window, width);
+}
+
+auto Api::nvim_win_text_height(integer window, table<string, any> opts) -> promise<table<string, any>> {
+    co_return co_await rpc_->call<table<string, any>>(options(), "nvim_win_text_height", window, opts);
+}
+
+auto Batch::State::value(std::size_t index) const -> Api::view {
+    if (!executed) {
+        throw std::logic_error("Batch is not executed");
+    }
+    if (!results.is_nil() && index < results.size()) {
+        return results[index];
+    }
+    if (index == error_index && !error.empty()) {
+        throw std::runtime_error(error);
+    }
+    throw std::runtime_error(
+        fmt::format("Call {} was not executed, batch failed at call {}: {}", index, error_index, error));
+}
+
+Batch::Batch(std::shared_ptr<rpc::Client> rpc, rpc::Cancellation* cancellation)
+    : rpc_{std::move(rpc)}
+    , cancellation_{cancellation}
+    , state_{std::make_shared<State>()} {}
+
+auto Batch::size() const -> std::size_t {
+    return state_->count;
+}
+
+auto Batch::execute() -> Api::promise<void> {
+    state_->executed = true;
+    if (!state_->count) {
+        co_return;
+    }
+
+    // [results, error], where error is nil or [index, type, message] of the first failed call
+    const auto response = co_await rpc_->call_view(rpc::CallOptions{.cancellation = cancellation_}, "nvim_call_atomic",
+                                                   rpc::PackedArray{state_->count, state_->calls});
+    state_->results = response[0];
+    if (const auto error = response[1]; !error.is_nil()) {
+        state_->error_index = error[0].as<std::size_t>();
+        state_->error = error[2].as<std::string>();
+        spdlog::error("Atomic call {} of {} failed: {}", state_->error_index, state_->count, state_->error);
+    }
+}
+
+auto Batch::nvim_buf_add_highlight(integer buffer, integer ns_id, string hl_group, integer line, integer col_start,
+                                   integer col_end) -> Result<integer> {
+    return add<integer>("nvim_buf_add_highlight", buffer, ns_id, hl_group, line, col_start, col_end);
+}
+
+auto Batch::nvim_buf_attach(integer buffer, boolean send_buffer, table<string, any> opts) -> Result<boolean> {
+    return add<boolean>("nvim_buf_attach", buffer, send_buffer, opts);
+}
+
+auto Batch::nvim_buf_clear_highlight(integer buffer, integer ns_id, integer line_start, integer line_end)
+    -> Result<void> {
+    return add<void>("nvim_buf_clear_highlight", buffer, ns_id, line_start, line_end);
+}
+
+auto Batch::nvim_buf_clear_namespace(integer buffer, integer ns_id, integer line_start, integer line_end)
+    -> Result<void> {
+    return add<void>("nvim_buf_clear_namespace", buffer, ns_id, line_start, line_end);
+}
+
+auto Batch::nvim_buf_create_user_command(integer buffer, string name, any command, table<string, any> opts)
+    -> Result<void> {
+    return add<void>("nvim_buf_create_user_command", buffer, name, command, opts);
+}
+
+auto Batch::nvim_buf_del_extmark(integer buffer, integer ns_id, integer id) -> Result<boolean> {
+    return add<boolean>("nvim_buf_del_extmark", buffer, ns_id, id);
+}
+
+auto Batch::nvim_buf_del_keymap(integer buffer, string mode, string lhs) -> Result<void> {
+    return add<void>("nvim_buf_del_keymap", buffer, mode, lhs);
+}
+
+auto Batch::nvim_buf_del_mark(integer buffer, string name) -> Result<boolean> {
+    return add<boolean>("nvim_buf_del_mark", buffer, name);
+}
+
+auto Batch::nvim_buf_del_user_command(integer buffer, string name) -> Result<void> {
+    return add<void>("nvim_buf_del_user_command", buffer, name);
+}
+
+auto Batch::nvim_buf_del_var(integer buffer, string name) -> Result<void> {
+    return add<void>("nvim_buf_del_var", buffer, name);
+}
+
+auto Batch::nvim_buf_delete(integer buffer, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_buf_delete", buffer, opts);
+}
+
+auto Batch::nvim_buf_get_changedtick(integer buffer) -> Result<integer> {
+    return add<integer>("nvim_buf_get_changedtick", buffer);
+}
+
+auto Batch::nvim_buf_get_commands(integer buffer, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_buf_get_commands", buffer, opts);
+}
+
+auto Batch::nvim_buf_get_extmark_by_id(integer buffer, integer ns_id, integer id, table<string, any> opts)
+    -> Result<any> {
+    return add<any>("nvim_buf_get_extmark_by_id", buffer, ns_id, id, opts);
+}
+
+auto Batch::nvim_buf_get_extmarks(integer buffer, integer ns_id, any start, any end_, table<string, any> opts)
+    -> Result<std::vector<any>> {
+    return add<std::vector<any>>("nvim_buf_get_extmarks", buffer, ns_id, start, end_, opts);
+}
+
+auto Batch::nvim_buf_get_keymap(integer buffer, string mode) -> Result<std::vector<table<string, any>>> {
+    return add<std::vector<table<string, any>>>("nvim_buf_get_keymap", buffer, mode);
+}
+
+auto Batch::nvim_buf_get_lines(integer buffer, integer start, integer end_, boolean strict_indexing)
+    -> Result<std::vector<string>> {
+    return add<std::vector<string>>("nvim_buf_get_lines", buffer, start, end_, strict_indexing);
+}
+
+auto Batch::nvim_buf_get_mark(integer buffer, string name) -> Result<std::vector<integer>> {
+    return add<std::vector<integer>>("nvim_buf_get_mark", buffer, name);
+}
+
+auto Batch::nvim_buf_get_name(integer buffer) -> Result<string> {
+    return add<string>("nvim_buf_get_name", buffer);
+}
+
+auto Batch::nvim_buf_get_number(integer buffer) -> Result<integer> {
+    return add<integer>("nvim_buf_get_number", buffer);
+}
+
+auto Batch::nvim_buf_get_offset(integer buffer, integer index) -> Result<integer> {
+    return add<integer>("nvim_buf_get_offset", buffer, index);
+}
+
+auto Batch::nvim_buf_get_option(integer buffer, string name) -> Result<any> {
+    return add<any>("nvim_buf_get_option", buffer, name);
+}
+
+auto Batch::nvim_buf_get_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                              table<string, any> opts) -> Result<std::vector<string>> {
+    return add<std::vector<string>>("nvim_buf_get_text", buffer, start_row, start_col, end_row, end_col, opts);
+}
+
+auto Batch::nvim_buf_get_var(integer buffer, string name) -> Result<any> {
+    return add<any>("nvim_buf_get_var", buffer, name);
+}
+
+auto Batch::nvim_buf_is_loaded(integer buffer) -> Result<boolean> {
+    return add<boolean>("nvim_buf_is_loaded", buffer);
+}
+
+auto Batch::nvim_buf_is_valid(integer buffer) -> Result<boolean> {
+    return add<boolean>("nvim_buf_is_valid", buffer);
+}
+
+auto Batch::nvim_buf_line_count(integer buffer) -> Result<integer> {
+    return add<integer>("nvim_buf_line_count", buffer);
+}
+
+auto Batch::nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, table<string, any> opts)
+    -> Result<integer> {
+    return add<integer>("nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
+}
+
+auto Batch::nvim_buf_set_extmark(integer buffer, integer ns_id, integer line, integer col, ExtmarkOpts opts)
+    -> Result<integer> {
+    return add<integer>("nvim_buf_set_extmark", buffer, ns_id, line, col, opts);
+}
+
+auto Batch::nvim_buf_set_keymap(integer buffer, string mode, string lhs, string rhs, table<string, any> opts)
+    -> Result<void> {
+    return add<void>("nvim_buf_set_keymap", buffer, mode, lhs, rhs, opts);
+}
+
+auto Batch::nvim_buf_set_lines(integer buffer, integer start, integer end_, boolean strict_indexing,
+                               std::vector<string> replacement) -> Result<void> {
+    return add<void>("nvim_buf_set_lines", buffer, start, end_, strict_indexing, replacement);
+}
+
+auto Batch::nvim_buf_set_mark(integer buffer, string name, integer line, integer col, table<string, any> opts)
+    -> Result<boolean> {
+    return add<boolean>("nvim_buf_set_mark", buffer, name, line, col, opts);
+}
+
+auto Batch::nvim_buf_set_name(integer buffer, string name) -> Result<void> {
+    return add<void>("nvim_buf_set_name", buffer, name);
+}
+
+auto Batch::nvim_buf_set_option(integer buffer, string name, any value) -> Result<void> {
+    return add<void>("nvim_buf_set_option", buffer, name, value);
+}
+
+auto Batch::nvim_buf_set_text(integer buffer, integer start_row, integer start_col, integer end_row, integer end_col,
+                              std::vector<string> replacement) -> Result<void> {
+    return add<void>("nvim_buf_set_text", buffer, start_row, start_col, end_row, end_col, replacement);
+}
+
+auto Batch::nvim_buf_set_var(integer buffer, string name, any value) -> Result<void> {
+    return add<void>("nvim_buf_set_var", buffer, name, value);
+}
+
+auto Batch::nvim_buf_set_virtual_text(integer buffer, integer src_id, integer line, std::vector<any> chunks,
+                                      table<string, any> opts) -> Result<integer> {
+    return add<integer>("nvim_buf_set_virtual_text", buffer, src_id, line, chunks, opts);
+}
+
+auto Batch::nvim_call_dict_function(any dict, string fn, std::vector<any> args) -> Result<any> {
+    return add<any>("nvim_call_dict_function", dict, fn, args);
+}
+
+auto Batch::nvim_call_function(string fn, std::vector<any> args) -> Result<any> {
+    return add<any>("nvim_call_function", fn, args);
+}
+
+auto Batch::nvim_chan_send(integer chan, string data) -> Result<void> {
+    return add<void>("nvim_chan_send", chan, data);
+}
+
+auto Batch::nvim_clear_autocmds(table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_clear_autocmds", opts);
+}
+
+auto Batch::nvim_cmd(table<string, any> cmd, table<string, any> opts) -> Result<string> {
+    return add<string>("nvim_cmd", cmd, opts);
+}
+
+auto Batch::nvim_command(string command) -> Result<void> {
+    return add<void>("nvim_command", command);
+}
+
+auto Batch::nvim_command_output(string command) -> Result<string> {
+    return add<string>("nvim_command_output", command);
+}
+
+auto Batch::nvim_complete_set(integer index, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_complete_set", index, opts);
+}
+
+auto Batch::nvim_create_augroup(string name, table<string, any> opts) -> Result<integer> {
+    return add<integer>("nvim_create_augroup", name, opts);
+}
+
+auto Batch::nvim_create_buf(boolean listed, boolean scratch) -> Result<integer> {
+    return add<integer>("nvim_create_buf", listed, scratch);
+}
+
+auto Batch::nvim_create_namespace(string name) -> Result<integer> {
+    return add<integer>("nvim_create_namespace", name);
+}
+
+auto Batch::nvim_create_user_command(string name, any command, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_create_user_command", name, command, opts);
+}
+
+auto Batch::nvim_del_augroup_by_id(integer id) -> Result<void> {
+    return add<void>("nvim_del_augroup_by_id", id);
+}
+
+auto Batch::nvim_del_augroup_by_name(string name) -> Result<void> {
+    return add<void>("nvim_del_augroup_by_name", name);
+}
+
+auto Batch::nvim_del_autocmd(integer id) -> Result<void> {
+    return add<void>("nvim_del_autocmd", id);
+}
+
+auto Batch::nvim_del_current_line() -> Result<void> {
+    return add<void>("nvim_del_current_line");
+}
+
+auto Batch::nvim_del_keymap(string mode, string lhs) -> Result<void> {
+    return add<void>("nvim_del_keymap", mode, lhs);
+}
+
+auto Batch::nvim_del_mark(string name) -> Result<boolean> {
+    return add<boolean>("nvim_del_mark", name);
+}
+
+auto Batch::nvim_del_user_command(string name) -> Result<void> {
+    return add<void>("nvim_del_user_command", name);
+}
+
+auto Batch::nvim_del_var(string name) -> Result<void> {
+    return add<void>("nvim_del_var", name);
+}
+
+auto Batch::nvim_echo(std::vector<any> chunks, boolean history, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_echo", chunks, history, opts);
+}
+
+auto Batch::nvim_err_write(string str) -> Result<void> {
+    return add<void>("nvim_err_write", str);
+}
+
+auto Batch::nvim_err_writeln(string str) -> Result<void> {
+    return add<void>("nvim_err_writeln", str);
+}
+
+auto Batch::nvim_eval(string expr) -> Result<any> {
+    return add<any>("nvim_eval", expr);
+}
+
+auto Batch::nvim_eval_statusline(string str, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_eval_statusline", str, opts);
+}
+
+auto Batch::nvim_exec(string src, boolean output) -> Result<string> {
+    return add<string>("nvim_exec", src, output);
+}
+
+auto Batch::nvim_exec2(string src, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_exec2", src, opts);
+}
+
+auto Batch::nvim_exec_autocmds(any event, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_exec_autocmds", event, opts);
+}
+
+auto Batch::nvim_feedkeys(string keys, string mode, boolean escape_ks) -> Result<void> {
+    return add<void>("nvim_feedkeys", keys, mode, escape_ks);
+}
+
+auto Batch::nvim_get_all_options_info() -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_all_options_info");
+}
+
+auto Batch::nvim_get_autocmds(table<string, any> opts) -> Result<std::vector<any>> {
+    return add<std::vector<any>>("nvim_get_autocmds", opts);
+}
+
+auto Batch::nvim_get_chan_info(integer chan) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_chan_info", chan);
+}
+
+auto Batch::nvim_get_color_by_name(string name) -> Result<integer> {
+    return add<integer>("nvim_get_color_by_name", name);
+}
+
+auto Batch::nvim_get_color_map() -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_color_map");
+}
+
+auto Batch::nvim_get_commands(table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_commands", opts);
+}
+
+auto Batch::nvim_get_context(table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_context", opts);
+}
+
+auto Batch::nvim_get_current_buf() -> Result<integer> {
+    return add<integer>("nvim_get_current_buf");
+}
+
+auto Batch::nvim_get_current_line() -> Result<string> {
+    return add<string>("nvim_get_current_line");
+}
+
+auto Batch::nvim_get_current_tabpage() -> Result<integer> {
+    return add<integer>("nvim_get_current_tabpage");
+}
+
+auto Batch::nvim_get_current_win() -> Result<integer> {
+    return add<integer>("nvim_get_current_win");
+}
+
+auto Batch::nvim_get_hl(integer ns_id, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_hl", ns_id, opts);
+}
+
+auto Batch::nvim_get_hl_by_id(integer hl_id, boolean rgb) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_hl_by_id", hl_id, rgb);
+}
+
+auto Batch::nvim_get_hl_by_name(string name, boolean rgb) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_hl_by_name", name, rgb);
+}
+
+auto Batch::nvim_get_hl_id_by_name(string name) -> Result<integer> {
+    return add<integer>("nvim_get_hl_id_by_name", name);
+}
+
+auto Batch::nvim_get_hl_ns(table<string, any> opts) -> Result<integer> {
+    return add<integer>("nvim_get_hl_ns", opts);
+}
+
+auto Batch::nvim_get_keymap(string mode) -> Result<std::vector<table<string, any>>> {
+    return add<std::vector<table<string, any>>>("nvim_get_keymap", mode);
+}
+
+auto Batch::nvim_get_mark(string name, table<string, any> opts) -> Result<std::vector<any>> {
+    return add<std::vector<any>>("nvim_get_mark", name, opts);
+}
+
+auto Batch::nvim_get_mode() -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_mode");
+}
+
+auto Batch::nvim_get_namespaces() -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_namespaces");
+}
+
+auto Batch::nvim_get_option(string name) -> Result<any> {
+    return add<any>("nvim_get_option", name);
+}
+
+auto Batch::nvim_get_option_info(string name) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_option_info", name);
+}
+
+auto Batch::nvim_get_option_info2(string name, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_get_option_info2", name, opts);
+}
+
+auto Batch::nvim_get_option_value(string name, table<string, any> opts) -> Result<any> {
+    return add<any>("nvim_get_option_value", name, opts);
+}
+
+auto Batch::nvim_get_proc(integer pid) -> Result<any> {
+    return add<any>("nvim_get_proc", pid);
+}
+
+auto Batch::nvim_get_proc_children(integer pid) -> Result<std::vector<any>> {
+    return add<std::vector<any>>("nvim_get_proc_children", pid);
+}
+
+auto Batch::nvim_get_runtime_file(string name, boolean all) -> Result<std::vector<string>> {
+    return add<std::vector<string>>("nvim_get_runtime_file", name, all);
+}
+
+auto Batch::nvim_get_var(string name) -> Result<any> {
+    return add<any>("nvim_get_var", name);
+}
+
+auto Batch::nvim_get_vvar(string name) -> Result<any> {
+    return add<any>("nvim_get_vvar", name);
+}
+
+auto Batch::nvim_input(string keys) -> Result<integer> {
+    return add<integer>("nvim_input", keys);
+}
+
+auto Batch::nvim_input_mouse(string button, string action, string modifier, integer grid, integer row, integer col)
+    -> Result<void> {
+    return add<void>("nvim_input_mouse", button, action, modifier, grid, row, col);
+}
+
+auto Batch::nvim_list_bufs() -> Result<std::vector<integer>> {
+    return add<std::vector<integer>>("nvim_list_bufs");
+}
+
+auto Batch::nvim_list_chans() -> Result<std::vector<any>> {
+    return add<std::vector<any>>("nvim_list_chans");
+}
+
+auto Batch::nvim_list_runtime_paths() -> Result<std::vector<string>> {
+    return add<std::vector<string>>("nvim_list_runtime_paths");
+}
+
+auto Batch::nvim_list_tabpages() -> Result<std::vector<integer>> {
+    return add<std::vector<integer>>("nvim_list_tabpages");
+}
+
+auto Batch::nvim_list_uis() -> Result<std::vector<any>> {
+    return add<std::vector<any>>("nvim_list_uis");
+}
+
+auto Batch::nvim_list_wins() -> Result<std::vector<integer>> {
+    return add<std::vector<integer>>("nvim_list_wins");
+}
+
+auto Batch::nvim_load_context(table<string, any> dict) -> Result<any> {
+    return add<any>("nvim_load_context", dict);
+}
+
+auto Batch::nvim_notify(string msg, integer log_level, table<string, any> opts) -> Result<any> {
+    return add<any>("nvim_notify", msg, log_level, opts);
+}
+
+auto Batch::nvim_open_term(integer buffer, table<string, any> opts) -> Result<integer> {
+    return add<integer>("nvim_open_term", buffer, opts);
+}
+
+auto Batch::nvim_open_win(integer buffer, boolean enter, table<string, any> config) -> Result<integer> {
+    return add<integer>("nvim_open_win", buffer, enter, config);
+}
+
+auto Batch::nvim_out_write(string str) -> Result<void> {
+    return add<void>("nvim_out_write", str);
+}
+
+auto Batch::nvim_parse_cmd(string str, table<string, any> opts) -> Result<any> {
+    return add<any>("nvim_parse_cmd", str, opts);
+}
+
+auto Batch::nvim_parse_expression(string expr, string flags, boolean highlight) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_parse_expression", expr, flags, highlight);
+}
+
+auto Batch::nvim_paste(string data, boolean crlf, integer phase) -> Result<boolean> {
+    return add<boolean>("nvim_paste", data, crlf, phase);
+}
+
+auto Batch::nvim_put(std::vector<string> lines, string type, boolean after, boolean follow) -> Result<void> {
+    return add<void>("nvim_put", lines, type, after, follow);
+}
+
+auto Batch::nvim_replace_termcodes(string str, boolean from_part, boolean do_lt, boolean special) -> Result<string> {
+    return add<string>("nvim_replace_termcodes", str, from_part, do_lt, special);
+}
+
+auto Batch::nvim_select_popupmenu_item(integer item, boolean insert, boolean finish, table<string, any> opts)
+    -> Result<void> {
+    return add<void>("nvim_select_popupmenu_item", item, insert, finish, opts);
+}
+
+auto Batch::nvim_set_current_buf(integer buffer) -> Result<void> {
+    return add<void>("nvim_set_current_buf", buffer);
+}
+
+auto Batch::nvim_set_current_dir(string dir) -> Result<void> {
+    return add<void>("nvim_set_current_dir", dir);
+}
+
+auto Batch::nvim_set_current_line(string line) -> Result<void> {
+    return add<void>("nvim_set_current_line", line);
+}
+
+auto Batch::nvim_set_current_tabpage(integer tabpage) -> Result<void> {
+    return add<void>("nvim_set_current_tabpage", tabpage);
+}
+
+auto Batch::nvim_set_current_win(integer window) -> Result<void> {
+    return add<void>("nvim_set_current_win", window);
+}
+
+auto Batch::nvim_set_decoration_provider(integer ns_id, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_set_decoration_provider", ns_id, opts);
+}
+
+auto Batch::nvim_set_hl(integer ns_id, string name, table<string, any> val) -> Result<void> {
+    return add<void>("nvim_set_hl", ns_id, name, val);
+}
+
+auto Batch::nvim_set_hl_ns(integer ns_id) -> Result<void> {
+    return add<void>("nvim_set_hl_ns", ns_id);
+}
+
+auto Batch::nvim_set_hl_ns_fast(integer ns_id) -> Result<void> {
+    return add<void>("nvim_set_hl_ns_fast", ns_id);
+}
+
+auto Batch::nvim_set_keymap(string mode, string lhs, string rhs, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_set_keymap", mode, lhs, rhs, opts);
+}
+
+auto Batch::nvim_set_option(string name, any value) -> Result<void> {
+    return add<void>("nvim_set_option", name, value);
+}
+
+auto Batch::nvim_set_option_value(string name, any value, table<string, any> opts) -> Result<void> {
+    return add<void>("nvim_set_option_value", name, value, opts);
+}
+
+auto Batch::nvim_set_var(string name, any value) -> Result<void> {
+    return add<void>("nvim_set_var", name, value);
+}
+
+auto Batch::nvim_set_vvar(string name, any value) -> Result<void> {
+    return add<void>("nvim_set_vvar", name, value);
+}
+
+auto Batch::nvim_strwidth(string text) -> Result<integer> {
+    return add<integer>("nvim_strwidth", text);
+}
+
+auto Batch::nvim_tabpage_del_var(integer tabpage, string name) -> Result<void> {
+    return add<void>("nvim_tabpage_del_var", tabpage, name);
+}
+
+auto Batch::nvim_tabpage_get_number(integer tabpage) -> Result<integer> {
+    return add<integer>("nvim_tabpage_get_number", tabpage);
+}
+
+auto Batch::nvim_tabpage_get_var(integer tabpage, string name) -> Result<any> {
+    return add<any>("nvim_tabpage_get_var", tabpage, name);
+}
+
+auto Batch::nvim_tabpage_get_win(integer tabpage) -> Result<integer> {
+    return add<integer>("nvim_tabpage_get_win", tabpage);
+}
+
+auto Batch::nvim_tabpage_is_valid(integer tabpage) -> Result<boolean> {
+    return add<boolean>("nvim_tabpage_is_valid", tabpage);
+}
+
+auto Batch::nvim_tabpage_list_wins(integer tabpage) -> Result<std::vector<integer>> {
+    return add<std::vector<integer>>("nvim_tabpage_list_wins", tabpage);
+}
+
+auto Batch::nvim_tabpage_set_var(integer tabpage, string name, any value) -> Result<void> {
+    return add<void>("nvim_tabpage_set_var", tabpage, name, value);
+}
+
+auto Batch::nvim_tabpage_set_win(integer tabpage, integer win) -> Result<void> {
+    return add<void>("nvim_tabpage_set_win", tabpage, win);
+}
+
+auto Batch::nvim_win_close(integer window, boolean force) -> Result<void> {
+    return add<void>("nvim_win_close", window, force);
+}
+
+auto Batch::nvim_win_del_var(integer window, string name) -> Result<void> {
+    return add<void>("nvim_win_del_var", window, name);
+}
+
+auto Batch::nvim_win_get_buf(integer window) -> Result<integer> {
+    return add<integer>("nvim_win_get_buf", window);
+}
+
+auto Batch::nvim_win_get_config(integer window) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_win_get_config", window);
+}
+
+auto Batch::nvim_win_get_cursor(integer window) -> Result<std::vector<integer>> {
+    return add<std::vector<integer>>("nvim_win_get_cursor", window);
+}
+
+auto Batch::nvim_win_get_height(integer window) -> Result<integer> {
+    return add<integer>("nvim_win_get_height", window);
+}
+
+auto Batch::nvim_win_get_number(integer window) -> Result<integer> {
+    return add<integer>("nvim_win_get_number", window);
+}
+
+auto Batch::nvim_win_get_option(integer window, string name) -> Result<any> {
+    return add<any>("nvim_win_get_option", window, name);
+}
+
+auto Batch::nvim_win_get_position(integer window) -> Result<Point> {
+    return add<Point>("nvim_win_get_position", window);
+}
+
+auto Batch::nvim_win_get_tabpage(integer window) -> Result<integer> {
+    return add<integer>("nvim_win_get_tabpage", window);
+}
+
+auto Batch::nvim_win_get_var(integer window, string name) -> Result<any> {
+    return add<any>("nvim_win_get_var", window, name);
+}
+
+auto Batch::nvim_win_get_width(integer window) -> Result<integer> {
+    return add<integer>("nvim_win_get_width", window);
+}
+
+auto Batch::nvim_win_hide(integer window) -> Result<void> {
+    return add<void>("nvim_win_hide", window);
+}
+
+auto Batch::nvim_win_is_valid(integer window) -> Result<boolean> {
+    return add<boolean>("nvim_win_is_valid", window);
+}
+
+auto Batch::nvim_win_set_buf(integer window, integer buffer) -> Result<void> {
+    return add<void>("nvim_win_set_buf", window, buffer);
+}
+
+auto Batch::nvim_win_set_config(integer window, table<string, any> config) -> Result<void> {
+    return add<void>("nvim_win_set_config", window, config);
+}
+
+auto Batch::nvim_win_set_cursor(integer window, std::vector<integer> pos) -> Result<void> {
+    return add<void>("nvim_win_set_cursor", window, pos);
+}
+
+auto Batch::nvim_win_set_height(integer window, integer height) -> Result<void> {
+    return add<void>("nvim_win_set_height", window, height);
+}
+
+auto Batch::nvim_win_set_hl_ns(integer window, integer ns_id) -> Result<void> {
+    return add<void>("nvim_win_set_hl_ns", window, ns_id);
+}
+
+auto Batch::nvim_win_set_option(integer window, string name, any value) -> Result<void> {
+    return add<void>("nvim_win_set_option", window, name, value);
+}
+
+auto Batch::nvim_win_set_var(integer window, string name, any value) -> Result<void> {
+    return add<void>("nvim_win_set_var", window, name, value);
+}
+
+auto Batch::nvim_win_set_width(integer window, integer width) -> Result<void> {
+    return add<void>("nvim_win_set_width", window, width);
+}
+
+auto Batch::nvim_win_text_height(integer window, table<string, any> opts) -> Result<table<string, any>> {
+    return add<table<string, any>>("nvim_win_text_height", window, opts);
 }
 
 } // namespace nvim
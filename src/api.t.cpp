@@ -1,12 +1,806 @@
 #include "api.hpp"
-#include "executor.hpp"
+#include "fake/replay.hpp"
+#include "fake/server.hpp"
+#include "graphics.hpp"
+#include "rpc.hpp"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <unistd.h>
 
-TEST(API, Breathing) {
-    auto& ctx = nvim::ExecutorSingleton::context();
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// runs the test body on its own event loop until the body is done
+template <typename Body>
+auto run(Body body) -> void {
+    boost::asio::io_context ctx{BOOST_ASIO_CONCURRENCY_HINT_1};
     boost::cobalt::this_thread::set_executor(ctx.get_executor());
-    auto api = nvim::Api::create("localhost", 1234);
-    (void)api;
+
+    std::exception_ptr error;
+    boost::cobalt::spawn(ctx, body(), [&](std::exception_ptr e) {
+        error = e;
+        ctx.stop();
+    });
+    ctx.run();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace
+
+TEST(API, Breathing) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        auto api = co_await nvim::Api::create(server.address());
+
+        EXPECT_EQ(api.rpc_channel(), 1);
+        EXPECT_EQ(server.connections(), 1u);
+        co_await server.stop();
+    });
+}
+
+TEST(API, TypedResults) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_buf_get_lines", std::vector<std::string>{"first", "second"});
+
+        // window handle 1000 as Neovim sends it, EXT with a packed uint16 inside
+        const char handle[] = {static_cast<char>(0xcd), 0x03, static_cast<char>(0xe8)};
+        server.respond("nvim_get_current_win", msgpack::type::ext(1, handle, sizeof(handle)));
+
+        auto api = co_await nvim::Api::create(server.address());
+
+        const auto lines = co_await api.nvim_buf_get_lines(0, 0, -1, false);
+        const auto win = co_await api.nvim_get_current_win();
+
+        EXPECT_THAT(lines, testing::ElementsAre("first", "second"));
+        EXPECT_EQ(win, 1000);
+        EXPECT_EQ(server.requests("nvim_buf_get_lines"), 1u);
+        co_await server.stop();
+    });
+}
+
+TEST(API, Helpers) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+
+        // [code, [name, args...]], the module itself is registered with no arguments
+        server.on("nvim_exec_lua", [](const rpc::ObjectView& args) {
+            if (args[1].size() && args[1][0].str() == "visible_lines")
+                return fake::result(std::map<std::string, int>{{"first", 10}, {"last", 50}});
+            return fake::Reply{};
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+        const auto lines = co_await api.visible_lines(1000);
+
+        EXPECT_EQ(lines.first, 10);
+        EXPECT_EQ(lines.last, 50);
+        EXPECT_EQ(server.requests("nvim_exec_lua"), 2u);
+        co_await server.stop();
+    });
+}
+
+TEST(API, TerminalQuery) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+
+        // [code, ["terminal_query", channel, id, query, reply, timeout]]
+        std::string id;
+        int timeout = 0;
+        server.on("nvim_exec_lua", [&](const rpc::ObjectView& args) {
+            if (args[1].size() && args[1][0].str() == "terminal_query") {
+                id = args[1][2].as<std::string>();
+                timeout = args[1][5].as<int>();
+            }
+            return fake::Reply{};
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+        auto reply = api.terminal_query("\x1b[14t", "\x1b%[4;%d+;%d+t", 250ms);
+
+        while (id.empty()) {
+            co_await boost::asio::post(co_await boost::asio::this_coro::executor, boost::cobalt::use_op);
+        }
+
+        // the responder notifies as soon as the terminal answered
+        co_await server.notify(id, fake::pack(std::string{"\x1b[4;800;1200t"}));
+        EXPECT_EQ(co_await reply, "\x1b[4;800;1200t");
+        EXPECT_EQ(timeout, 250);
+        co_await server.stop();
+    });
+}
+
+TEST(API, Errors) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.on("nvim_command", [](const rpc::ObjectView& args) {
+            return fake::error("E492: Not an editor command: " + args[0].as<std::string>());
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+
+        EXPECT_THROW(co_await api.nvim_command("foo"), std::runtime_error);
+        EXPECT_THROW(co_await api.nvim_get_current_line(), std::runtime_error);
+        co_await server.stop();
+    });
+}
+
+TEST(API, ErrorResults) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.on("nvim_buf_get_extmark_by_id", [](const rpc::ObjectView&) {
+            return fake::error("Invalid buffer id: 7");
+        });
+        server.on("nvim_win_get_position", [](const rpc::ObjectView&) {
+            return fake::result(std::make_tuple(3, 5));
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+
+        const auto mark = co_await api.try_nvim_buf_get_extmark_by_id(7, 1, 1, {});
+        EXPECT_FALSE(mark);
+        if (!mark) {
+            EXPECT_EQ(mark.error().type, rpc::ErrorType::Exception);
+            EXPECT_EQ(mark.error().message, "Invalid buffer id: 7");
+        }
+
+        const auto position = co_await api.try_nvim_win_get_position(1000);
+        EXPECT_TRUE(position);
+        if (position) {
+            EXPECT_EQ(position->x, 5);
+            EXPECT_EQ(position->y, 3);
+        }
+
+        server.set_latency(200ms);
+        api.set_timeout(20ms);
+        const auto closed = co_await api.try_nvim_win_close(1000, true);
+        EXPECT_FALSE(closed);
+        if (!closed)
+            EXPECT_EQ(closed.error().type, rpc::ErrorType::Timeout);
+        co_await server.stop();
+    });
+}
+
+TEST(API, Batch) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+
+        // [[method, args]...] is answered with [results, error], the second batch fails at its second call
+        std::vector<std::size_t> sizes;
+        server.on("nvim_call_atomic", [&](const rpc::ObjectView& args) {
+            sizes.push_back(args[0].size());
+            if (sizes.size() == 1) {
+                const auto results = std::make_tuple(std::vector<std::string>{"first", "second"}, 42,
+                                                     msgpack::type::nil_t{});
+                return fake::result(std::make_tuple(results, msgpack::type::nil_t{}));
+            }
+            const auto results = std::make_tuple(1000);
+            return fake::result(std::make_tuple(results, std::make_tuple(1, 0, std::string{"Invalid buffer id: 7"})));
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+
+        auto batch = api.batch();
+        const auto lines = batch.nvim_buf_get_lines(0, 0, -1, false);
+        const auto count = batch.nvim_buf_line_count(0);
+        const auto command = batch.nvim_command("redraw");
+        EXPECT_THROW(count.get(), std::logic_error);
+
+        co_await batch.execute();
+        EXPECT_THAT(lines.get(), testing::ElementsAre("first", "second"));
+        EXPECT_EQ(count.get(), 42);
+        EXPECT_NO_THROW(command.get());
+
+        auto failing = api.batch();
+        const auto win = failing.nvim_get_current_win();
+        const auto failed = failing.nvim_buf_line_count(7);
+        const auto skipped = failing.nvim_command("redraw");
+        co_await failing.execute();
+
+        EXPECT_EQ(win.get(), 1000);
+        const auto message = [](const auto& result) -> std::string {
+            try {
+                result.get();
+            } catch (const std::runtime_error& e) {
+                return e.what();
+            }
+            return {};
+        };
+        EXPECT_EQ(message(failed), "Invalid buffer id: 7");
+        EXPECT_THAT(message(skipped), testing::HasSubstr("not executed"));
+        EXPECT_THAT(sizes, testing::ElementsAre(3u, 3u));
+        EXPECT_EQ(server.requests("nvim_call_atomic"), 2u);
+        co_await server.stop();
+    });
+}
+
+TEST(API, Timeout) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_get_current_line", std::string{"line"});
+
+        auto api = co_await nvim::Api::create(server.address());
+
+        server.set_latency(200ms);
+        api.set_timeout(20ms);
+        EXPECT_THROW(co_await api.nvim_get_current_line(), rpc::TimeoutError);
+
+        server.set_latency(0us);
+        const auto line = co_await api.nvim_get_current_line();
+        EXPECT_EQ(line, "line");
+        co_await server.stop();
+    });
+}
+
+TEST(API, Lanes) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_buf_get_lines", std::vector<std::string>{"line"});
+
+        auto api = co_await nvim::Api::create(server.address());
+        co_await api.open_bulk_lane();
+        EXPECT_EQ(server.connections(), 2u);
+
+        auto bulk = api.lane(nvim::Lane::Bulk);
+        const auto lines = co_await bulk.nvim_buf_get_lines(0, 0, -1, false);
+        EXPECT_THAT(lines, testing::ElementsAre("line"));
+
+        // notification ids are shared by the lanes
+        const auto first = api.next_notification_id();
+        EXPECT_EQ(bulk.next_notification_id(), first + 1);
+        EXPECT_THAT(api.metrics_report(), testing::HasSubstr("bulk lane"));
+        co_await server.stop();
+    });
+}
+
+TEST(API, SingleFlight) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_get_current_win", 1000);
+        server.respond("nvim_win_get_height", 40);
+        server.set_latency(20ms);
+
+        auto api = co_await nvim::Api::create(server.address());
+        api.enable_single_flight();
+
+        // the same question three times and a different one, while the first is in flight
+        auto [a, b, c, height] = co_await boost::cobalt::join(api.nvim_get_current_win(), api.nvim_get_current_win(),
+                                                              api.nvim_get_current_win(), api.nvim_win_get_height(1));
+        EXPECT_EQ(a, 1000);
+        EXPECT_EQ(b, 1000);
+        EXPECT_EQ(c, 1000);
+        EXPECT_EQ(height, 40);
+        EXPECT_EQ(server.requests("nvim_get_current_win"), 1u);
+
+        // once it has landed the next call is sent again
+        const auto win = co_await api.nvim_get_current_win();
+        EXPECT_EQ(win, 1000);
+        EXPECT_EQ(server.requests("nvim_get_current_win"), 2u);
+        co_await server.stop();
+    });
+}
+
+TEST(API, StateCache) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_get_current_win", 1000);
+        int visible_lines = 0;
+        server.on("nvim_exec_lua", [&](const rpc::ObjectView& args) {
+            if (args[1].size() && args[1][0].str() == "visible_lines") {
+                ++visible_lines;
+                return fake::result(std::map<std::string, int>{{"first", 1}, {"last", 40}});
+            }
+            return fake::Reply{};
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+        // the cache registers its autocmd with the next notification id
+        const auto id = api.next_notification_id() + 1;
+        co_await api.enable_state_cache(1);
+
+        co_await api.nvim_get_current_win();
+        const auto win = co_await api.nvim_get_current_win();
+        EXPECT_EQ(win, 1000);
+        EXPECT_EQ(server.requests("nvim_get_current_win"), 1u);
+
+        const auto event = std::map<std::string, std::string>{{"event", "WinEnter"}};
+        co_await server.notify(std::to_string(id), fake::pack(event));
+        auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor, 10ms};
+        co_await timer.async_wait(boost::cobalt::use_op);
+
+        co_await api.nvim_get_current_win();
+        EXPECT_EQ(server.requests("nvim_get_current_win"), 2u);
+
+        // helpers are cached under their own name
+        co_await api.visible_lines(1000);
+        co_await api.visible_lines(1000);
+        EXPECT_EQ(visible_lines, 1);
+
+        // invalidated by the reader, before anything else runs
+        const auto scrolled = std::map<std::string, std::string>{{"event", "WinScrolled"}};
+        co_await server.notify(std::to_string(id), fake::pack(scrolled));
+        timer.expires_after(10ms);
+        co_await timer.async_wait(boost::cobalt::use_op);
+        co_await api.visible_lines(1000);
+        EXPECT_EQ(visible_lines, 2);
+
+        // window geometry is dropped on every layout change, e.g. a split
+        server.respond("nvim_win_get_width", 80);
+        co_await api.nvim_win_get_width(1000);
+        const auto split = std::map<std::string, std::string>{{"event", "WinNew"}};
+        co_await server.notify(std::to_string(id), fake::pack(split));
+        timer.expires_after(10ms);
+        co_await timer.async_wait(boost::cobalt::use_op);
+        EXPECT_EQ(co_await api.nvim_win_get_width(1000), 80);
+        EXPECT_EQ(server.requests("nvim_win_get_width"), 2u);
+        co_await server.stop();
+    });
+}
+
+TEST(API, Autocmd) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+
+        // [code, ["create_autocmd", channel, id, event, opts, filter]]
+        std::string id;
+        std::map<std::string, int> throttle;
+        server.on("nvim_exec_lua", [&](const rpc::ObjectView& args) {
+            if (args[1].size() && args[1][0].str() == "create_autocmd") {
+                id = args[1][2].as<std::string>();
+                throttle = args[1][5].as<std::map<std::string, int>>();
+            }
+            return fake::Reply{};
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+        auto events = api.nvim_create_autocmd({"BufEnter"}, nvim::AutocmdOpts{.pattern = {{"*.md"}}},
+                                              nvim::EventFilter{.throttle = 30});
+
+        while (id.empty()) {
+            co_await boost::asio::post(co_await boost::asio::this_coro::executor, boost::cobalt::use_op);
+        }
+
+        co_await server.stream(
+            id,
+            [](std::size_t i) {
+                return fake::pack(std::map<std::string, std::size_t>{{"buf", i}});
+            },
+            3, 0);
+
+        for (std::size_t i = 0; i < 3; ++i) {
+            const auto ev = (co_await events)[0];
+            EXPECT_EQ(ev.find("buf")->as<std::size_t>(), i);
+        }
+
+        // unset filters are not sent
+        EXPECT_EQ(throttle, (std::map<std::string, int>{{"throttle", 30}}));
+        co_await server.stop();
+    });
+}
+
+TEST(RPC, Metrics) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_get_current_line", std::string{"hello"});
+        server.on("nvim_command", [](const rpc::ObjectView&) {
+            return fake::error("failed");
+        });
+
+        rpc::Client client{server.address()};
+        co_await client.init();
+        for (int i = 0; i < 3; ++i) {
+            co_await client.call<std::string>("nvim_get_current_line");
+        }
+        EXPECT_THROW(co_await client.call<void>("nvim_command", "foo"), std::runtime_error);
+
+        const auto& line = client.metrics().methods().at("nvim_get_current_line");
+        EXPECT_EQ(line.calls, 3u);
+        EXPECT_EQ(line.errors, 0u);
+        EXPECT_EQ(line.in_flight, 0u);
+        EXPECT_EQ(line.latency.count(), 3u);
+        EXPECT_GT(line.bytes_out, 0u);
+        EXPECT_GT(line.bytes_in, 0u);
+
+        const auto& command = client.metrics().methods().at("nvim_command");
+        EXPECT_EQ(command.calls, 1u);
+        EXPECT_EQ(command.errors, 1u);
+        EXPECT_THAT(client.report(), testing::HasSubstr("nvim_get_current_line"));
+        co_await server.stop();
+    });
+}
+
+TEST(RPC, Cancellation) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_get_current_line", std::string{"line"});
+        server.set_latency(50ms);
+
+        rpc::Client client{server.address()};
+        co_await client.init();
+
+        rpc::Cancellation cancellation;
+        const auto call = [&]() -> boost::cobalt::promise<std::string> {
+            co_return co_await client.call<std::string>(rpc::CallOptions{.cancellation = &cancellation},
+                                                        "nvim_get_current_line");
+        };
+        auto pending = call();
+        while (client.slot_stats().in_flight == 0) {
+            co_await boost::asio::post(co_await boost::asio::this_coro::executor, boost::cobalt::use_op);
+        }
+
+        cancellation.cancel();
+        EXPECT_THROW(co_await pending, rpc::CancelledError);
+        EXPECT_EQ(client.slot_stats().in_flight, 0u);
+
+        // the response arrives after the slot was released
+        auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor, 100ms};
+        co_await timer.async_wait(boost::cobalt::use_op);
+        EXPECT_EQ(client.slot_stats().stale, 1u);
+        EXPECT_EQ(server.requests("nvim_get_current_line"), 1u);
+
+        // the api passes it to its calls and batches, which are not sent once it's cancelled
+        auto api = (co_await nvim::Api::create(server.address())).cancellable(cancellation);
+        EXPECT_THROW(co_await api.nvim_get_current_line(), rpc::CancelledError);
+        const auto closed = co_await api.lane(nvim::Lane::Bulk).try_nvim_win_close(1000, true);
+        EXPECT_FALSE(closed);
+        if (!closed)
+            EXPECT_EQ(closed.error().type, rpc::ErrorType::Cancelled);
+        auto batch = api.batch();
+        batch.nvim_get_current_line();
+        EXPECT_THROW(co_await batch.execute(), rpc::CancelledError);
+        EXPECT_EQ(server.requests("nvim_get_current_line"), 1u);
+        co_await server.stop();
+    });
+}
+
+TEST(RPC, SubscriptionWake) {
+    run([]() -> boost::cobalt::task<void> {
+        auto ex = co_await boost::asio::this_coro::executor;
+        rpc::Subscription subscription{{}};
+
+        std::vector<int> values;
+        bool nil = false;
+        const auto consume = [&]() -> boost::cobalt::promise<void> {
+            while (values.size() < 3) {
+                const auto value = co_await subscription.next();
+                nil |= value.is_nil();
+                values.push_back(value.is_nil() ? 0 : value.as<int>());
+            }
+        };
+        auto consumer = consume();
+
+        // as the reader does, resumes are posted for the pushes which ask for them
+        const auto push = [&](int value) {
+            if (subscription.push(rpc::ObjectView{nullptr, msgpack::object(value)})) {
+                boost::asio::post(ex, [&] {
+                    subscription.resume();
+                });
+                return true;
+            }
+            return false;
+        };
+        const auto settle = [&]() -> boost::cobalt::promise<void> {
+            for (int i = 0; i < 4; ++i) {
+                co_await boost::asio::post(ex, boost::cobalt::use_op);
+            }
+        };
+
+        // two notifications of one read wake the waiting consumer once, it takes both
+        EXPECT_TRUE(push(1));
+        EXPECT_FALSE(push(2));
+        // a stale resume finds the queue empty, the consumer keeps waiting
+        boost::asio::post(ex, [&] {
+            subscription.resume();
+        });
+        co_await settle();
+        EXPECT_EQ(values, (std::vector<int>{1, 2}));
+
+        EXPECT_TRUE(push(3));
+        co_await consumer;
+        EXPECT_EQ(values, (std::vector<int>{1, 2, 3}));
+        EXPECT_FALSE(nil);
+    });
+}
+
+TEST(RPC, Coalesce) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+
+        rpc::Client client{server.address()};
+        co_await client.init();
+
+        // a busy subscriber, events of two buffers arrive while it holds the first one
+        auto events = client.notifications(
+            7, rpc::SubscriptionOptions{.coalesce = true, .key = [](const rpc::ObjectView& msg) {
+                                            return msg[0].find("buf")->as<std::size_t>();
+                                        }});
+        co_await server.stream(
+            "7",
+            [](std::size_t i) {
+                return fake::pack(std::map<std::string, std::size_t>{{"buf", i % 2}, {"seq", i}});
+            },
+            10, 0);
+        auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor, 10ms};
+        co_await timer.async_wait(boost::cobalt::use_op);
+
+        // only the latest event of each buffer is left
+        std::vector<std::size_t> seq;
+        do {
+            seq.push_back((co_await events)[0].find("seq")->as<std::size_t>());
+        } while (client.subscription_stats(7).depth);
+
+        const auto stats = client.subscription_stats(7);
+        EXPECT_EQ(stats.received, 10u);
+        EXPECT_GE(stats.coalesced, 6u);
+        EXPECT_LE(stats.max_depth, 2u);
+        EXPECT_EQ(stats.lag.count(), stats.consumed);
+        EXPECT_THAT(std::vector(seq.end() - 2, seq.end()), testing::UnorderedElementsAre(8, 9));
+        co_await server.stop();
+    });
+}
+
+TEST(RPC, RecordReplay) {
+    run([]() -> boost::cobalt::task<void> {
+        const auto path = (std::filesystem::temp_directory_path() / ("record-" + std::to_string(getpid()) + ".rpc"))
+                              .string();
+        {
+            fake::Server server{co_await boost::asio::this_coro::executor};
+            std::size_t lines = 0;
+            server.on("nvim_get_current_line", [&](const rpc::ObjectView&) {
+                return fake::result("line " + std::to_string(++lines));
+            });
+            // [code, [name, args...]], helper calls are answered with their name
+            server.on("nvim_exec_lua", [](const rpc::ObjectView& args) {
+                return fake::result(args[1][0].as<std::string>() + " reply");
+            });
+
+            rpc::Client client{server.address()};
+            auto recorder = std::make_shared<rpc::Recorder>(path);
+            client.record(recorder);
+            co_await client.init();
+
+            auto events = client.notifications(7);
+            EXPECT_EQ(co_await client.call<std::string>("nvim_get_current_line"), "line 1");
+            EXPECT_EQ(co_await client.call<std::string>("nvim_get_current_line"), "line 2");
+            co_await client.call<std::string>("nvim_exec_lua", "code", std::make_tuple("first"));
+            co_await client.call<std::string>("nvim_exec_lua", "code", std::make_tuple("second"));
+            co_await server.notify("7", fake::pack(42));
+            EXPECT_EQ((co_await events)[0].as<int>(), 42);
+
+            // closes the file
+            client.record(nullptr);
+            co_await server.stop();
+        }
+
+        // 5 requests and their responses, then the notification
+        const auto frames = rpc::Recorder::read(path);
+        std::filesystem::remove(path);
+        // ASSERT_* can't leave a coroutine
+        EXPECT_EQ(frames.size(), 11u);
+        if (frames.size() != 11u)
+            co_return;
+        EXPECT_EQ(frames.front().direction, rpc::Direction::Out);
+        EXPECT_EQ(frames.back().direction, rpc::Direction::In);
+        for (std::size_t i = 1; i < frames.size(); ++i) {
+            EXPECT_LE(frames[i - 1].time, frames[i].time);
+        }
+
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        fake::Replayer replayer{server, frames};
+        EXPECT_EQ(replayer.notifications(), 1u);
+
+        rpc::Client client{server.address()};
+        co_await client.init();
+        auto events = client.notifications(7);
+
+        // replies of a method come in the recorded order and the last one repeats, helpers are matched by name
+        EXPECT_EQ(co_await client.call<std::string>("nvim_exec_lua", "code", std::make_tuple("second")),
+                  "second reply");
+        EXPECT_EQ(co_await client.call<std::string>("nvim_get_current_line"), "line 1");
+        EXPECT_EQ(co_await client.call<std::string>("nvim_exec_lua", "code", std::make_tuple("first")),
+                  "first reply");
+        EXPECT_EQ(co_await client.call<std::string>("nvim_get_current_line"), "line 2");
+        EXPECT_EQ(co_await client.call<std::string>("nvim_get_current_line"), "line 2");
+
+        const auto stats = co_await replayer.play(0);
+        EXPECT_EQ(stats.notifications, 1u);
+        EXPECT_EQ(stats.stalls, 0u);
+        EXPECT_EQ((co_await events)[0].as<int>(), 42);
+        co_await server.stop();
+    });
+}
+
+TEST(RPC, SlotTable) {
+    rpc::SlotTable<int> table{16};
+
+    // a released slot is taken again only after the others, its old id never matches again
+    const auto first = table.acquire();
+    table.release(first);
+    std::uint32_t last{};
+    for (int i = 0; i < 70000; ++i) {
+        last = table.acquire();
+        EXPECT_FALSE(table.complete(first, 1));
+        table.release(last);
+    }
+    EXPECT_EQ(last, 70000u);
+    EXPECT_EQ(table.stats().stale, 70000u);
+
+    // requests in flight keep their ids when the table grows
+    std::vector<std::uint32_t> ids;
+    for (int i = 0; i < 20; ++i) {
+        ids.push_back(table.acquire());
+    }
+    EXPECT_EQ(table.stats().capacity, 32u);
+    for (const auto id : ids) {
+        EXPECT_TRUE(table.complete(id, static_cast<int>(id)));
+    }
+    EXPECT_EQ(table.stats().in_flight, 20u);
+}
+
+TEST(RPC, Address) {
+    using Kind = rpc::Address::Kind;
+
+    EXPECT_EQ(rpc::Address::parse("-").kind, Kind::Stdio);
+    EXPECT_EQ(rpc::Address::parse("stdio").kind, Kind::Stdio);
+
+    const auto path = rpc::Address::parse("unix:nvim.sock");
+    EXPECT_EQ(path.kind, Kind::Unix);
+    EXPECT_EQ(path.host, "nvim.sock");
+    EXPECT_EQ(rpc::Address::parse("/tmp/nvim.sock").host, "/tmp/nvim.sock");
+
+    const auto tcp = rpc::Address::parse("tcp:localhost:6666");
+    EXPECT_EQ(tcp.kind, Kind::Tcp);
+    EXPECT_EQ(tcp.host, "localhost");
+    EXPECT_EQ(tcp.port, "6666");
+
+    const auto ipv6 = rpc::Address::parse("[::1]:6666");
+    EXPECT_EQ(ipv6.kind, Kind::Tcp);
+    EXPECT_EQ(ipv6.host, "::1");
+    EXPECT_EQ(ipv6.port, "6666");
+
+    // a bare name is neither a socket path nor host:port
+    EXPECT_THROW(rpc::Address::parse("localhost"), std::invalid_argument);
+    EXPECT_THROW(rpc::Address::parse("localhost:"), std::invalid_argument);
+    EXPECT_THROW(rpc::Address::parse("unix:"), std::invalid_argument);
+}
+
+TEST(RPC, ReceiveStats) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.respond("nvim_get_current_line", std::string{"line"});
+        server.respond("nvim_buf_get_name", std::string(100 * 1024, 'x'));
+
+        rpc::Client client{server.address()};
+        co_await client.init();
+        co_await client.call<std::string>("nvim_get_current_line");
+        EXPECT_EQ(client.receive_stats().zone_growths, 0u);
+
+        // the string is copied into the zone, which needs more chunks for it every time
+        for (int i = 0; i < 2; ++i) {
+            co_await client.call<std::string>("nvim_buf_get_name", 0);
+        }
+        const auto stats = client.receive_stats();
+        EXPECT_EQ(stats.messages, 4u);
+        EXPECT_EQ(stats.zone_growths, 2u);
+        EXPECT_GT(stats.allocations_per_mb(), 0);
+        co_await server.stop();
+    });
+}
+
+TEST(RPC, Histogram) {
+    rpc::Histogram histogram;
+    for (std::uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i);
+    }
+
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.max(), 1000u);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(0.5)), 500, 500 / 16.0);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(0.99)), 990, 990 / 16.0);
+    EXPECT_EQ(histogram.percentile(1), 1000u);
+}
+
+TEST(RPC, FrameScanner) {
+    msgpack::sbuffer buffer;
+    msgpack::pack(buffer, std::make_tuple(1, 42u, std::string(300, 'x'), std::map<std::string, int>{{"buf", 7}}));
+    const auto first = buffer.size();
+    msgpack::pack(buffer, std::vector<int>{1, 2, 3});
+
+    // bytes arrive one at a time, the first message completes with its last byte
+    rpc::FrameScanner scanner;
+    std::size_t size = 0;
+    std::optional<std::size_t> message;
+    while (!message && size < buffer.size()) {
+        message = scanner.scan(buffer.data(), ++size);
+    }
+
+    EXPECT_EQ(message, first);
+    EXPECT_EQ(scanner.scan(buffer.data() + first, buffer.size() - first), buffer.size() - first);
+}
+
+TEST(Graphics, Position) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+
+        // [code, ["window_origin", window, offsets_only]], the number column gets wider after the first call
+        int left = 4;
+        std::vector<bool> offsets_only;
+        server.on("nvim_exec_lua", [&](const rpc::ObjectView& args) {
+            if (args[1].size() && args[1][0].str() == "window_origin") {
+                offsets_only.push_back(args[1][2].as<bool>());
+                const auto window = offsets_only.back() ? 0 : 1;
+                return fake::result(
+                    std::map<std::string, int>{{"row", 3 * window}, {"col", 8 * window}, {"top", 1}, {"left", left}});
+            }
+            return fake::Reply{};
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+        nvim::Graphics graphics{api, 1, "/dev/null"};
+
+        // the window is located once per layout, its offsets every time, the cursor stays where it is
+        const auto first = co_await graphics.position(1000);
+        left = 6;
+        const auto second = co_await graphics.position(1000);
+        EXPECT_EQ(first.x, 12);
+        EXPECT_EQ(first.y, 4);
+        EXPECT_EQ(second.x, 14);
+        EXPECT_EQ(second.y, 4);
+        EXPECT_EQ(offsets_only, (std::vector<bool>{false, true}));
+        EXPECT_EQ(server.requests("nvim_win_set_cursor"), 0u);
+        co_await server.stop();
+    });
+}
+
+TEST(Graphics, Tty) {
+    run([]() -> boost::cobalt::task<void> {
+        fake::Server server{co_await boost::asio::this_coro::executor};
+        server.on("nvim_exec_lua", [](const rpc::ObjectView& args) {
+            if (args[1].size() && args[1][0].str() == "getpid")
+                return fake::result(static_cast<int>(::getpid()));
+            return fake::Reply{};
+        });
+
+        auto api = co_await nvim::Api::create(server.address());
+        nvim::Graphics graphics{api};
+
+        // the terminal of the test or /dev/null without one, found the same way again
+        const auto tty = co_await graphics.get_tty();
+        EXPECT_TRUE(std::filesystem::exists(tty)) << tty;
+        EXPECT_EQ(co_await graphics.get_tty(), tty);
+        co_await server.stop();
+    });
+}
+
+TEST(Graphics, TerminalCaps) {
+    // replies of kitty on this host to the probe, the file query failed
+    const auto caps = nvim::TerminalCaps::parse("\x1b[4;800;1200t\x1b[6;20;10t\x1b_Gi=31;OK\x1b\\"
+                                                "\x1b_Gi=32;ENOENT:no such file\x1b\\\x1b[?2026;2$y\x1b[?62;4c");
+    EXPECT_EQ(caps.screen.w, 1200);
+    EXPECT_EQ(caps.screen.h, 800);
+    EXPECT_EQ(caps.cell.w, 10);
+    EXPECT_EQ(caps.cell.h, 20);
+    EXPECT_TRUE(caps.kitty);
+    EXPECT_FALSE(caps.kitty_files);
+    EXPECT_TRUE(caps.synchronized_update);
+
+    // only DA1, a terminal without any of it
+    const auto none = nvim::TerminalCaps::parse("\x1b[?1;2c");
+    EXPECT_EQ(none.screen.w, 0);
+    EXPECT_FALSE(none.kitty);
+    EXPECT_FALSE(none.synchronized_update);
 }
@@ -0,0 +1,130 @@
+#include "fake/replay.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+
+namespace fake {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+// how long a notification waits for the client to catch up with the recorded requests
+constexpr auto stall_limit = 1s;
+constexpr auto poll_interval = 200us;
+
+// Replies are queued per method, and per helper for the calls of the Lua helper module, which all go through
+// nvim_exec_lua as [code, [name, args...]] and may run in another order than recorded
+auto reply_key(std::string_view method, const rpc::ObjectView& args) -> std::string {
+    if (method == "nvim_exec_lua" && args.size() > 1) {
+        const auto call = args[1];
+        if (call.get().type == msgpack::type::ARRAY && call.size() && call[0].get().type == msgpack::type::STR)
+            return fmt::format("{}:{}", method, call[0].str());
+    }
+    return std::string{method};
+}
+
+} // namespace
+
+Replayer::Replayer(Server& server, const std::vector<rpc::Frame>& frames)
+    : server_{server} {
+    std::unordered_map<std::uint32_t, std::string> methods;
+    std::size_t requests = 0;
+
+    for (const auto& frame : frames) {
+        const auto oh = msgpack::unpack(frame.data.data(), frame.data.size());
+        const auto message = rpc::ObjectView{nullptr, oh.get()};
+        const auto type = static_cast<rpc::MessageType>(message[0].as<std::uint32_t>());
+
+        if (frame.direction == rpc::Direction::Out) {
+            // [type, msgid, method, args], responses to Neovim are not replayed
+            if (type == rpc::MessageType::Request) {
+                methods[message[1].as<std::uint32_t>()] = reply_key(message[2].str(), message[3]);
+                ++requests;
+            }
+        } else if (type == rpc::MessageType::Response) {
+            // [type, msgid, error, result]
+            const auto it = methods.find(message[1].as<std::uint32_t>());
+            if (it == methods.end())
+                continue;
+
+            const auto error = message[2];
+            replies_[it->second].push_back(error.is_nil() ? result(message[3].get())
+                                                          : fake::error(error[error.size() - 1].as<std::string>()));
+            methods.erase(it);
+        } else if (type == rpc::MessageType::Notify) {
+            // [type, method, args]
+            const auto args = message[2];
+            if (args.size() != 1) {
+                spdlog::warn("Skipping notification {} with {} arguments", message[1].str(), args.size());
+                continue;
+            }
+            notifications_.push_back(Notification{.time = frame.time,
+                                                  .requests = requests,
+                                                  .method = message[1].as<std::string>(),
+                                                  .arg = pack(args[0].get())});
+        }
+    }
+
+    std::set<std::string> replied;
+    for (const auto& [key, _] : replies_) {
+        replied.insert(key.substr(0, key.find(':')));
+    }
+    for (const auto& method : replied) {
+        server_.on(method, [this, method](const rpc::ObjectView& args) {
+            const auto it = replies_.find(reply_key(method, args));
+            if (it == replies_.end())
+                return Reply{};
+
+            auto& replies = it->second;
+            auto reply = replies.front();
+            if (replies.size() > 1)
+                replies.pop_front();
+            return reply;
+        });
+    }
+}
+
+auto Replayer::play(double speed) -> boost::cobalt::promise<ReplayStats> {
+    auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor};
+    const auto start = Clock::now();
+    const auto first = notifications_.empty() ? 0ns : notifications_.front().time;
+
+    ReplayStats stats;
+    for (const auto& notification : notifications_) {
+        const auto waiting = Clock::now();
+        while (server_.requests() < notification.requests) {
+            if (Clock::now() - waiting > stall_limit) {
+                ++stats.stalls;
+                break;
+            }
+            timer.expires_after(poll_interval);
+            co_await timer.async_wait(boost::cobalt::use_op);
+        }
+
+        if (speed > 0) {
+            const auto offset = std::chrono::duration<double, std::nano>((notification.time - first).count() / speed);
+            timer.expires_at(start + std::chrono::duration_cast<Clock::duration>(offset));
+            co_await timer.async_wait(boost::cobalt::use_op);
+        }
+
+        co_await server_.notify(notification.method, notification.arg);
+        ++stats.notifications;
+    }
+
+    stats.recorded = notifications_.empty() ? 0ns : notifications_.back().time - first;
+    stats.replayed = Clock::now() - start;
+    co_return stats;
+}
+
+auto Replayer::notifications() const -> std::size_t {
+    return notifications_.size();
+}
+
+} // namespace fake
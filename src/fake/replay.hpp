@@ -0,0 +1,50 @@
+#pragma once
+
+#include "fake/server.hpp"
+#include "recorder.hpp"
+
+#include <boost/cobalt.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fake {
+
+struct ReplayStats {
+    std::size_t notifications{};
+    std::size_t stalls{}; // notifications sent without the client having made the requests recorded before them
+    std::chrono::nanoseconds recorded{};
+    std::chrono::nanoseconds replayed{};
+};
+
+// Plays a recorded session back through the fake server.
+// Requests are answered with the recorded replies of the same method in the recorded order, the last one repeats.
+// Calls of the Lua helper module are matched by the name of the helper, not only by nvim_exec_lua.
+// Recorded notifications are sent on the recorded schedule, but never before the client has made the requests
+// which preceded them in the recording, so the code under test sees events in the same order.
+class Replayer {
+    struct Notification {
+        std::chrono::nanoseconds time{};
+        std::size_t requests{}; // client requests recorded before the notification
+        std::string method;
+        Packed arg;
+    };
+
+    Server& server_;
+    std::map<std::string, std::deque<Reply>> replies_;
+    std::vector<Notification> notifications_;
+
+public:
+    Replayer(Server& server, const std::vector<rpc::Frame>& frames);
+
+    // speed scales the recorded time, 10 sends events 10 times as fast, zero as fast as the client keeps up
+    auto play(double speed) -> boost::cobalt::promise<ReplayStats>;
+
+    auto notifications() const -> std::size_t;
+};
+
+} // namespace fake
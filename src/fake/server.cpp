@@ -0,0 +1,180 @@
+#include "fake/server.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <filesystem>
+#include <tuple>
+#include <utility>
+
+#include <unistd.h>
+
+namespace fake {
+
+namespace {
+
+auto socket_path() -> std::string {
+    static std::atomic<int> counter{0};
+    const auto name = fmt::format("fake-nvim-{}-{}.sock", ::getpid(), counter++);
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+auto bind(const boost::asio::any_io_executor& ex, const std::string& path)
+    -> boost::asio::local::stream_protocol::acceptor {
+    std::filesystem::remove(path);
+    return boost::asio::local::stream_protocol::acceptor{ex, boost::asio::local::stream_protocol::endpoint{path}};
+}
+
+} // namespace
+
+Server::Server(const boost::asio::any_io_executor& ex)
+    : path_{socket_path()}
+    , acceptor_{bind(ex, path_)} {
+    // [channel, metadata]
+    respond("nvim_get_api_info", std::make_tuple(1, std::map<std::string, int>{}));
+    respond("nvim_exec_lua", msgpack::type::nil_t{});
+
+    accept_task_.emplace(accept());
+}
+
+Server::~Server() {
+    if (stopped_)
+        return;
+
+    boost::system::error_code ignored;
+    acceptor_.close(ignored);
+    for (auto& connection : connections_) {
+        connection->closed = true;
+        connection->socket.close();
+    }
+    std::filesystem::remove(path_, ignored);
+}
+
+auto Server::stop() -> boost::cobalt::promise<void> {
+    if (std::exchange(stopped_, true))
+        co_return;
+
+    boost::system::error_code ignored;
+    acceptor_.close(ignored);
+    if (accept_task_)
+        co_await *accept_task_;
+
+    // the readers of closed connections stop, replies still waiting for their latency are dropped
+    for (auto& connection : connections_) {
+        connection->closed = true;
+        connection->socket.close();
+    }
+    for (auto& task : serving_) {
+        co_await task;
+    }
+    std::filesystem::remove(path_, ignored);
+}
+
+auto Server::address() const -> std::string {
+    return "unix:" + path_;
+}
+
+auto Server::on(std::string method, Handler handler) -> void {
+    handlers_.insert_or_assign(std::move(method), std::move(handler));
+}
+
+auto Server::set_latency(std::chrono::microseconds latency) -> void {
+    latency_ = latency;
+}
+
+auto Server::requests(std::string_view method) const -> std::size_t {
+    const auto it = requests_.find(method);
+    return it != requests_.end() ? it->second : 0;
+}
+
+auto Server::requests() const -> std::size_t {
+    return total_requests_;
+}
+
+auto Server::connections() const -> std::size_t {
+    return connections_.size();
+}
+
+auto Server::notify(std::string method, Packed arg) -> boost::cobalt::promise<void> {
+    for (auto& connection : connections_) {
+        co_await connection->socket.notify(method, arg);
+    }
+}
+
+auto Server::stream(std::string method, std::function<Packed(std::size_t)> arg, std::size_t count, double rate)
+    -> boost::cobalt::promise<void> {
+    using Clock = std::chrono::steady_clock;
+
+    auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor};
+    const auto start = Clock::now();
+    const auto interval = rate > 0 ? std::chrono::duration<double>(1.0 / rate) : std::chrono::duration<double>{};
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (rate > 0) {
+            // scheduled from the start, so the rate doesn't drift with the time spent sending
+            timer.expires_at(start + std::chrono::duration_cast<Clock::duration>(interval * i));
+            co_await timer.async_wait(boost::cobalt::use_op);
+        }
+        co_await notify(method, arg(i));
+    }
+}
+
+auto Server::accept() -> boost::cobalt::promise<void> {
+    try {
+        while (acceptor_.is_open()) {
+            auto socket = co_await acceptor_.async_accept(boost::cobalt::use_op);
+            const auto& connection =
+                connections_.emplace_back(std::make_shared<Connection>(rpc::Transport{std::move(socket)}));
+            serving_.push_back(serve(connection));
+        }
+    } catch (const boost::system::system_error& e) {
+        if (e.code() != boost::system::errc::operation_canceled)
+            spdlog::error("Fake server failed to accept: {}", e.what());
+    }
+}
+
+auto Server::serve(std::shared_ptr<Connection> connection) -> boost::cobalt::promise<void> {
+    auto ex = co_await boost::asio::this_coro::executor;
+
+    auto reader = connection->socket.receive();
+    while (reader) {
+        const auto message = co_await reader;
+        if (message.is_nil())
+            break;
+
+        // [type, msgid, method, args], responses and notifications from the client are ignored
+        if (static_cast<rpc::MessageType>(message[0].as<std::uint32_t>()) != rpc::MessageType::Request)
+            continue;
+
+        const auto msgid = message[1].as<std::uint32_t>();
+        const auto method = message[2].str();
+        ++requests_[std::string{method}];
+        ++total_requests_;
+
+        const auto it = handlers_.find(method);
+        auto reply = it != handlers_.end() ? it->second(message[3]) : error(fmt::format("Invalid method: {}", method));
+
+        // replies are sent from their own tasks, reading goes on while they wait for the latency
+        boost::cobalt::spawn(ex, answer(connection, latency_, msgid, std::move(reply)), boost::asio::detached);
+    }
+}
+
+auto Server::answer(std::shared_ptr<Connection> connection, std::chrono::microseconds latency, std::uint32_t msgid,
+                    Reply reply) -> boost::cobalt::task<void> {
+    if (latency.count()) {
+        auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor, latency};
+        co_await timer.async_wait(boost::cobalt::use_op);
+    }
+    if (connection->closed)
+        co_return;
+
+    if (reply.error.empty()) {
+        co_await connection->socket.reply(msgid, msgpack::type::nil_t{}, reply.result);
+    } else {
+        // Neovim sends errors as [type, message]
+        co_await connection->socket.reply(msgid, std::make_tuple(0, reply.error), msgpack::type::nil_t{});
+    }
+}
+
+} // namespace fake
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "rpc.hpp"
+
+#include <boost/asio.hpp>
+#include <boost/cobalt.hpp>
+#include <msgpack.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fake {
+
+// Value packed in advance, written to the wire as it is
+struct Packed {
+    std::string data;
+};
+
+template <typename T>
+auto pack(const T& value) -> Packed {
+    msgpack::sbuffer buffer;
+    msgpack::pack(buffer, value);
+    return Packed{std::string{buffer.data(), buffer.size()}};
+}
+
+// Answer to a request, the result or an error message
+struct Reply {
+    Packed result{pack(msgpack::type::nil_t{})};
+    std::string error;
+};
+
+template <typename T>
+auto result(const T& value) -> Reply {
+    return Reply{.result = pack(value)};
+}
+
+inline auto error(std::string message) -> Reply {
+    return Reply{.error = std::move(message)};
+}
+
+// In-process stand-in for Neovim, runs on the executor of the code under test.
+// Listens on a unix socket and answers requests with canned or computed replies after a configurable latency,
+// notifications are injected on demand or at a given rate. Await `stop()` before it goes out of scope.
+// `nvim_get_api_info` and `nvim_exec_lua` are answered out of the box, so `Api::create` and autocmds work.
+class Server {
+public:
+    // computes the reply from the request arguments
+    using Handler = std::function<Reply(const rpc::ObjectView& args)>;
+
+    explicit Server(const boost::asio::any_io_executor& ex);
+    ~Server();
+
+    Server(const Server&) = delete;
+    auto operator=(const Server&) -> Server& = delete;
+
+    // Closes the listening socket and all connections and waits for their tasks to finish.
+    // The destructor only closes the sockets, the tasks may still be suspended on them then.
+    auto stop() -> boost::cobalt::promise<void>;
+
+    // address to connect `rpc::Client` or `nvim::Api` to
+    auto address() const -> std::string;
+
+    auto on(std::string method, Handler handler) -> void;
+
+    template <typename T>
+    auto respond(std::string method, const T& value) -> void {
+        on(std::move(method), [reply = result(value)](const rpc::ObjectView&) {
+            return reply;
+        });
+    }
+
+    // delay of every reply, requests are still read and answered concurrently
+    auto set_latency(std::chrono::microseconds latency) -> void;
+
+    // number of requests received for the method and in total
+    auto requests(std::string_view method) const -> std::size_t;
+    auto requests() const -> std::size_t;
+    auto connections() const -> std::size_t;
+
+    // sends a notification with a single argument, e.g. the `ev` of an autocmd, to every connected client
+    auto notify(std::string method, Packed arg) -> boost::cobalt::promise<void>;
+
+    // sends `count` notifications evenly spread at `rate` per second, zero rate sends them as fast as possible
+    auto stream(std::string method, std::function<Packed(std::size_t)> arg, std::size_t count, double rate)
+        -> boost::cobalt::promise<void>;
+
+private:
+    struct Connection {
+        explicit Connection(rpc::Transport transport)
+            : socket{std::move(transport)} {}
+
+        rpc::Socket socket;
+        bool closed{}; // by the server, delayed replies are dropped
+    };
+
+    auto accept() -> boost::cobalt::promise<void>;
+
+    // the task and the delayed replies own the connection, so it lives as long as the last of them
+    auto serve(std::shared_ptr<Connection> connection) -> boost::cobalt::promise<void>;
+
+    // runs detached and may outlive the server, so it owns what it needs
+    static auto answer(std::shared_ptr<Connection> connection, std::chrono::microseconds latency, std::uint32_t msgid,
+                       Reply reply) -> boost::cobalt::task<void>;
+
+    std::string path_;
+    boost::asio::local::stream_protocol::acceptor acceptor_;
+    std::map<std::string, Handler, std::less<>> handlers_;
+    std::map<std::string, std::size_t, std::less<>> requests_;
+    std::size_t total_requests_{};
+    std::vector<std::shared_ptr<Connection>> connections_;
+    std::vector<boost::cobalt::promise<void>> serving_;
+    std::chrono::microseconds latency_{};
+    std::optional<boost::cobalt::promise<void>> accept_task_;
+    bool stopped_{};
+};
+
+} // namespace fake
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
+    namespace adaptor {
+
+    template <>
+    struct pack<fake::Packed> {
+        template <typename Stream>
+        auto operator()(msgpack::packer<Stream>& o, const fake::Packed& v) const -> msgpack::packer<Stream>& {
+            o.pack_bin_body(v.data.data(), v.data.size());
+            return o;
+        }
+    };
+
+    } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
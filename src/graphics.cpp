@@ -3,122 +3,211 @@
 #include "geometry.hpp"
 #include "spdlog/spdlog.h"
 
+#include <boost/beast/core/detail/base64.hpp>
 #include <fcntl.h>
 #include <fmt/core.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
 
 #include <filesystem>
+#include <fstream>
+#include <optional>
+#include <regex>
+#include <sstream>
 
 namespace nvim {
 
-Graphics::Graphics(Api& api, int attempts)
+namespace {
+
+// image ids of the kitty queries of the probe
+constexpr int probe_direct_id = 31;
+constexpr int probe_file_id = 32;
+
+// everything up to the DA1 reply, the last one as it's the last query
+constexpr auto probe_reply = "^.-\x1b%[%?[%d;]*c";
+
+// parent and controlling terminal of a process, zero if it has none
+struct ProcessStat {
+    int ppid{};
+    unsigned tty{};
+};
+
+auto read_stat(int pid) -> std::optional<ProcessStat> {
+    std::ifstream ifs{fmt::format("/proc/{}/stat", pid)};
+    std::string stat;
+    if (!std::getline(ifs, stat))
+        return std::nullopt;
+
+    // the command name is in parentheses and may contain anything, state, ppid, pgrp, session and tty_nr follow it
+    const auto end = stat.rfind(')');
+    if (end == std::string::npos)
+        return std::nullopt;
+
+    std::istringstream fields{stat.substr(end + 1)};
+    char state{};
+    int ppid{}, pgrp{}, session{};
+    unsigned tty{};
+    if (!(fields >> state >> ppid >> pgrp >> session >> tty))
+        return std::nullopt;
+    return ProcessStat{.ppid = ppid, .tty = tty};
+}
+
+// path of a terminal by the device number of /proc/<pid>/stat
+auto device_path(unsigned tty) -> std::string {
+    const auto major = (tty >> 8) & 0xfff;
+    const auto minor = (tty & 0xff) | ((tty >> 12) & 0xfff00);
+
+    // pseudo terminal slaves, majors 136 to 143
+    if (major >= 136 && major <= 143)
+        return fmt::format("/dev/pts/{}", (major - 136) * 256 + minor);
+
+    // consoles and serial lines are rare, look for the device
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator{"/dev", ec}; !ec && it != std::filesystem::directory_iterator{};
+         it.increment(ec)) {
+        struct stat st {};
+        if (::stat(it->path().c_str(), &st) == 0 && S_ISCHR(st.st_mode) && st.st_rdev == makedev(major, minor))
+            return it->path().string();
+    }
+    return {};
+}
+
+auto base64(std::string_view data) -> std::string {
+    std::string encoded(boost::beast::detail::base64::encoded_size(data.size()), '\0');
+    encoded.resize(boost::beast::detail::base64::encode(encoded.data(), data.data(), data.size()));
+    return encoded;
+}
+
+} // namespace
+
+auto TerminalCaps::parse(std::string_view replies) -> TerminalCaps {
+    // text area and cell size, kitty graphics responses and the state of mode 2026
+    static const std::regex reply{R"(\x1b\[([46]);(\d+);(\d+)t|\x1b_Gi=(\d+);([^\x1b]*)\x1b\\|\x1b\[\?2026;(\d)\$y)"};
+
+    TerminalCaps caps;
+    const auto end = std::cregex_iterator{};
+    for (auto it = std::cregex_iterator{replies.data(), replies.data() + replies.size(), reply}; it != end; ++it) {
+        const auto& m = *it;
+        if (m[1].matched) {
+            const auto size = Size{.w = std::stoi(m[3]), .h = std::stoi(m[2])};
+            (m[1] == "4" ? caps.screen : caps.cell) = size;
+        } else if (m[4].matched) {
+            const auto ok = m[5] == "OK";
+            const auto id = std::stoi(m[4]);
+            caps.kitty |= id == probe_direct_id && ok;
+            caps.kitty_files |= id == probe_file_id && ok;
+        } else if (m[6].matched) {
+            // 1 set, 2 reset, 0 and 4 mean it's not supported
+            caps.synchronized_update = m[6] == "1" || m[6] == "2";
+        }
+    }
+    return caps;
+}
+
+Graphics::Graphics(Api& api, int attempts, std::string tty)
     : api_{api}
-    , retry_count_{attempts} {}
+    , retry_count_{attempts}
+    , tty_{std::move(tty)} {}
 
 auto Graphics::api() -> Api& {
     return api_;
 }
 
+auto Graphics::set_query_timeout(std::chrono::milliseconds timeout) -> void {
+    query_timeout_ = timeout;
+}
+
 auto Graphics::init() -> boost::cobalt::promise<void> {
-    tty_ = co_await get_tty();
+    if (tty_.empty()) {
+        tty_ = co_await get_tty();
+    }
     ofs_.open(tty_, std::ios::binary);
     co_await update();
 }
 
 auto Graphics::update() -> boost::cobalt::promise<void> {
-    struct winsize size;
+    struct winsize size {};
 
     auto fd = open(tty_.c_str(), O_RDONLY | O_NOCTTY);
-    ioctl(fd, TIOCGWINSZ, &size);
+    if (ioctl(fd, TIOCGWINSZ, &size) != 0 || !size.ws_col || !size.ws_row) {
+        // not a terminal, e.g. a replay
+        size = {.ws_row = 24, .ws_col = 80};
+    }
     close(fd);
 
-    screen_size_ = decltype(screen_size_){};
-
-    auto pxsize = co_await screen_size();
     terminal_size_ = Size{.w = size.ws_col, .h = size.ws_row};
+    caps_ = co_await probe();
+
+    // the cell size is derived from the text area for terminals which don't report it, and the other way round
+    screen_size_ = caps_.screen;
+    cell_size_ = caps_.cell;
+    if (!cell_size_.w || !cell_size_.h) {
+        cell_size_ = Size{.w = screen_size_.w ? screen_size_.w / terminal_size_.w : 1,
+                          .h = screen_size_.h ? screen_size_.h / terminal_size_.h : 1};
+    } else if (!screen_size_.w || !screen_size_.h) {
+        screen_size_ = Size{.w = cell_size_.w * terminal_size_.w, .h = cell_size_.h * terminal_size_.h};
+    }
 
-    cell_size_ = Size{.w = screen_size_.w ? screen_size_.w / terminal_size_.w : 1,
-                      .h = screen_size_.h ? screen_size_.h / terminal_size_.h : 1};
-
-    spdlog::info("Detected sizes, screen: {}, terminal: {}, cell: {}", pxsize, terminal_size_, cell_size_);
+    spdlog::info("Detected sizes, screen: {}, terminal: {}, cell: {}, kitty: {}, files: {}, synchronized: {}",
+                 screen_size_, terminal_size_, cell_size_, caps_.kitty, caps_.kitty_files, caps_.synchronized_update);
 }
 
-auto Graphics::run_lua_io(const std::string_view data) -> boost::cobalt::promise<std::string> {
-    const int id = api_.next_notification_id();
-    const std::string lua_code = fmt::format(R"(
-local uv = require("luv")
-local timer = uv.new_timer()
-local stdin = uv.new_tty(0, true)
-local stdout = uv.new_tty(1, false)
-local result = ""
-
-local function close()
-  timer:stop()
-  timer:close()
-  stdin:close()
-  uv.stop()
-end
-
-timer:start(100, 0, close)
-stdin:read_start(function(err, data)
-  result = data
-  close()
-end)
+auto Graphics::handle_layout(int augroup) -> boost::cobalt::promise<void> {
+    auto gen = api_.nvim_create_autocmd(Api::layout_events(), AutocmdOpts{.group = augroup});
+    while (gen) {
+        const auto msg = co_await gen;
+        if (msg.is_nil())
+            break;
 
-stdout:write("\x1b{2}")
-stdout:close()
-uv.run()
-vim.fn["rpcnotify"]({0}, '{1}', result)
+        ++layout_;
+        positions_.clear();
+        if (msg[0].find("event")->str() == "VimResized")
+            co_await update();
+    }
+}
 
-    )",
+auto Graphics::caps() const -> const TerminalCaps& {
+    return caps_;
+}
 
-                                             api_.rpc_channel(), id, data);
+auto Graphics::query(const std::string_view data, const std::string_view reply)
+    -> boost::cobalt::promise<std::string> {
+    co_return co_await api_.terminal_query(std::string{data}, std::string{reply}, query_timeout_);
+}
 
-    const std::string path = fmt::format("/tmp/nvim-cpp.{}.lua", id);
-    std::shared_ptr<void> dummy{nullptr, [&path](auto) {
-                                    std::filesystem::remove(path);
-                                }};
+auto Graphics::probe() -> boost::cobalt::promise<TerminalCaps> {
+    // kitty only answers the file query if it could read the file, which it deletes after reading
+    const auto path = std::filesystem::temp_directory_path() /
+                      fmt::format("tty-graphics-protocol-jupyter-probe-{}", getpid());
 
-    {
-        std::ofstream ofs{path};
-        ofs.write(lua_code.data(), lua_code.size());
-    }
+    for (int attempts = retry_count_; attempts; --attempts) {
+        std::ofstream{path, std::ios::binary}.write("\0\0\0", 3);
 
-    auto response = api_.notification(id);
-    co_await api_.nvim_exec2(fmt::format("source {}", path), {});
-    const auto res = co_await response;
-    co_return res.as_vector().front().as_string();
-}
+        const auto queries = fmt::format("\x1b[14t\x1b[16t"
+                                         "\x1b_Gi={},s=1,v=1,a=q,t=d,f=24;AAAA\x1b\\"
+                                         "\x1b_Gi={},s=1,v=1,a=q,t=t,f=24;{}\x1b\\"
+                                         "\x1b[?2026$p\x1b[c",
+                                         probe_direct_id, probe_file_id, base64(path.string()));
+        const auto replies = co_await query(queries, probe_reply);
 
-auto Graphics::screen_size() -> boost::cobalt::promise<Size> {
-    int attempts = retry_count_;
-    while (attempts && !screen_size_.w && !screen_size_.h) {
-        const auto data = co_await run_lua_io("[14t");
-
-        // clang-format off
-        const auto parts = 
-            data | 
-            ranges::views::split(';') |
-            ranges::views::transform([](auto&& rng) {
-                return std::string_view(&*rng.begin(), ranges::distance(rng));
-            }) |
-            ranges::view::drop_exactly(1) | 
-            ranges::views::transform([](auto s) { return std::atoi(s.data()); }) |
-            ranges::to<std::vector<int>>();
-        // clang-format on
-
-        if (parts.size() == 2) {
-            screen_size_ = Size{.w = parts.back(), .h = parts.front()};
-        }
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
 
-        --attempts;
+        if (!replies.empty())
+            co_return TerminalCaps::parse(replies);
     }
-    co_return screen_size_;
+    co_return {};
 }
 
 auto Graphics::stream() -> std::ostream& {
     return ofs_;
 }
 
+auto Graphics::screen_size() -> Size {
+    return screen_size_;
+}
+
 auto Graphics::terminal_size() -> Size {
     return terminal_size_;
 }
@@ -128,37 +217,61 @@ auto Graphics::cell_size() -> Size {
 }
 
 auto Graphics::get_tty() -> boost::cobalt::promise<std::string> {
-    const auto output = co_await api_.nvim_exec2("lua print(vim.fn['getpid']())", {{"output", true}});
-
-    int pid = std::atoi(output.find("output")->second.as_string().c_str());
+    const int nvim = co_await api_.nvim_pid();
+    if (const auto it = ttys_.find(nvim); it != ttys_.end())
+        co_return it->second;
 
+    // the first process up the tree with a controlling terminal, Neovim itself unless a UI embeds it
     std::string tty;
-    while (pid) {
-        std::future<std::string> data;
-        boost::process::system(fmt::format("ps -p {0} -o tty=", pid), boost::process::std_out > data);
-        tty = data.get();
-        if (!tty.starts_with("?")) {
-            if (!tty.empty()) {
-                tty.pop_back();
-            }
+    for (int pid = nvim; pid > 0 && tty.empty();) {
+        const auto stat = read_stat(pid);
+        if (!stat)
             break;
-        }
+        if (stat->tty)
+            tty = device_path(stat->tty);
+        pid = stat->ppid;
+    }
 
-        std::future<std::string> pdata;
-        boost::process::system(fmt::format("ps -o ppid= {0}", pid), boost::process::std_out > pdata);
-        pid = std::stoi(pdata.get());
+    if (tty.empty()) {
+        spdlog::warn("No terminal found for Neovim process {}", nvim);
+        co_return "/dev/null";
     }
 
-    co_return "/dev/" + tty;
+    ttys_.emplace(nvim, tty);
+    co_return tty;
 }
 
 auto Graphics::position(int win_id) -> boost::cobalt::promise<Point> {
+    // the window itself only moves with the layout, the offsets of its text are asked for every time
+    std::optional<Point> cached;
+    if (const auto it = positions_.find(win_id); it != positions_.end())
+        cached = it->second;
+
+    // a position computed before a layout change arrived after it is not cached, it may predate the change
+    const auto layout = layout_;
+    std::optional<Point> position;
+    try {
+        const auto origin = co_await api_.window_origin(win_id, cached.has_value());
+        const auto window = cached.value_or(Point{.x = origin.col, .y = origin.row});
+        if (!cached && layout == layout_)
+            positions_.insert_or_assign(win_id, window);
+        position = Point{.x = window.x + origin.left, .y = window.y + origin.top};
+    } catch (const std::exception& e) {
+        spdlog::debug("Failed to get origin of window {}, asking the terminal: {}", win_id, e.what());
+    }
+
+    if (!position)
+        position = co_await cursor_position(win_id);
+    co_return *position;
+}
+
+auto Graphics::cursor_position(int win_id) -> boost::cobalt::promise<Point> {
     const auto cursor = co_await api_.nvim_win_get_cursor(win_id);
     co_await api_.nvim_win_set_cursor(win_id, {1, 0});
 
     int attempts = retry_count_;
     while (attempts) {
-        const auto data = co_await run_lua_io("[6n");
+        const auto data = co_await query("\x1b[6n", "\x1b%[%d+;%d+R");
 
         if (!data.empty()) {
             // clang-format off
@@ -184,11 +297,9 @@ auto Graphics::position(int win_id) -> boost::cobalt::promise<Point> {
     co_return {};
 }
 
-auto Graphics::visible_area() -> boost::cobalt::promise<std::pair<int, int>> {
-    const auto [first, last] =
-        co_await boost::cobalt::join(api_.nvim_exec2("lua print(vim.fn['line']('w0'))", {{"output", true}}),
-                                     api_.nvim_exec2("lua print(vim.fn['line']('w$'))", {{"output", true}}));
-    co_return {std::stoi(first.find("output")->second.as_string()), std::stoi(last.find("output")->second.as_string())};
+auto Graphics::visible_area(int win_id) -> boost::cobalt::promise<std::pair<int, int>> {
+    const auto lines = co_await api_.visible_lines(win_id);
+    co_return {lines.first, lines.last};
 }
 
 } // namespace nvim
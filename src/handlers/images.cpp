@@ -54,16 +54,13 @@ auto handle_images(nvim::Api& api, nvim::Graphics& graphics, int augroup) -> boo
                 "BufEnter",
                 "BufLeave",
             },
-            {
-                {"pattern", std::vector<nvim::Api::any>{"*.png"}},
-                {"group", augroup},
-            });
+            nvim::AutocmdOpts{.group = augroup, .pattern = std::vector<std::string>{"*.png"}});
 
         while (gen) {
             auto msg = co_await gen;
-            const auto data = msg.as_vector().front().as_multimap();
-            const auto event = data.find("event")->second.as_string();
-            const auto id = data.find("buf")->second.as_uint64_t();
+            const auto data = msg[0];
+            const auto event = data.find("event")->str();
+            const auto id = data.find("buf")->as<int>();
             const auto win_id = co_await api.nvim_get_current_win();
 
             if (event == "BufEnter") {
@@ -77,7 +74,7 @@ auto handle_images(nvim::Api& api, nvim::Graphics& graphics, int augroup) -> boo
                     //
                     co_await boost::cobalt::join(api.nvim_buf_set_lines(id, 0, -1, false, {""}),
                                                  api.nvim_buf_set_option(id, "buftype", "nowrite"));
-                    Buffer b{graphics, static_cast<int>(id), data.find("file")->second.as_string()};
+                    Buffer b{graphics, id, data.find("file")->as<std::string>()};
                     it = buffers.emplace(id, std::move(b)).first;
                 }
 
@@ -101,15 +98,13 @@ auto handle_images(nvim::Api& api, nvim::Graphics& graphics, int augroup) -> boo
                 "WinClosed",
                 "WinEnter",
             },
-            {
-                {"group", augroup},
-            });
+            nvim::AutocmdOpts{.group = augroup});
 
         while (gen) {
             auto msg = co_await gen;
-            const auto data = msg.as_vector().front().as_multimap();
-            const auto event = data.find("event")->second.as_string();
-            const auto buf = data.find("buf")->second.as_uint64_t();
+            const auto data = msg[0];
+            const auto event = data.find("event")->str();
+            const auto buf = data.find("buf")->as<int>();
 
             auto it = buffers.find(buf);
             if (it == buffers.end())
@@ -120,7 +115,7 @@ auto handle_images(nvim::Api& api, nvim::Graphics& graphics, int augroup) -> boo
                 spdlog::debug("Entered window {}, id: {}", msg, win_id);
                 co_await it->second.draw(api, win_id);
             } else if (event == "WinClosed") {
-                const auto win = std::stoi(data.find("file")->second.as_string());
+                const auto win = std::stoi(data.find("file")->as<std::string>());
                 spdlog::debug("Closed window {}, data {}", win, msg);
                 co_await it->second.clear(win);
             }
@@ -73,13 +73,15 @@ public:
             co_await boost::cobalt::join(promises);
         }
 
-        const auto existing = co_await api.nvim_buf_get_extmarks(id_, ns_id, 0, -1, {});
-        std::vector<boost::cobalt::promise<bool>> promises;
-        for (const auto mark : existing) {
-            promises.push_back(api.nvim_buf_del_extmark(id_, ns_id, mark.as_vector().front().as_uint64_t()));
+        // drop stale marks in one round trip, on the bulk lane as there can be many of them
+        auto bulk = api.lane(nvim::Lane::Bulk);
+        const auto existing = co_await bulk.nvim_buf_get_extmarks(id_, ns_id, 0, -1, {});
+        auto batch = bulk.batch();
+        for (const auto& mark : existing) {
+            batch.nvim_buf_del_extmark(id_, ns_id, mark.as_vector().front().as_uint64_t());
         }
 
-        co_await boost::cobalt::join(promises);
+        co_await batch.execute();
     }
 
     auto update() -> boost::cobalt::promise<void> {
@@ -136,25 +138,23 @@ auto handle_markdown(nvim::Api& api, nvim::Graphics& remote, int augroup) -> boo
                 "BufEnter",
                 "BufLeave",
             },
-            {
-                {"pattern", std::vector<nvim::Api::any>{"*.md"}},
-                {"group", augroup},
-            });
+            nvim::AutocmdOpts{.group = augroup, .pattern = std::vector<std::string>{"*.md"}});
 
         int last_win = 0;
         while (gen) {
             auto msg = co_await gen;
-            const auto data = msg.as_vector().front().as_multimap();
-            const auto event = data.find("event")->second.as_string();
-            const auto id = data.find("buf")->second.as_uint64_t();
+            const auto data = msg[0];
+            const auto event = data.find("event")->str();
+            const auto id = data.find("buf")->as<int>();
 
             if (event == "BufEnter") {
                 auto it = buffers.find(id);
                 if (it == buffers.end()) {
                     spdlog::debug("New Buffer event {}", msg);
-                    Buffer b{remote, static_cast<int>(id), data.find("file")->second.as_string()};
+                    Buffer b{remote, id, data.find("file")->as<std::string>()};
                     co_await b.load();
                     it = buffers.emplace(id, std::move(b)).first;
+                    co_await api.allow_buffer("markdown", id);
                 }
 
                 last_win = co_await it->second.draw();
@@ -164,8 +164,8 @@ auto handle_markdown(nvim::Api& api, nvim::Graphics& remote, int augroup) -> boo
                     spdlog::debug("Left buffer, window {}, data {}", last_win, msg);
                     co_await it->second.clear(last_win);
                 }
-            } else {
-                buffers.erase(id);
+            } else if (buffers.erase(id)) {
+                co_await api.allow_buffer("markdown", id, false);
             }
         }
     };
@@ -177,15 +177,29 @@ auto handle_markdown(nvim::Api& api, nvim::Graphics& remote, int augroup) -> boo
                 // "WinResized",
                 // "WinScrolled",
             },
-            {
-                {"group", augroup},
+            nvim::AutocmdOpts{.group = augroup},
+            // only events of loaded markdown buffers are sent, cursor movement at most every 30 ms
+            nvim::EventFilter{.buffers = "markdown",
+                              .fields = std::vector<std::string>{"event", "buf", "win", "file"},
+                              .throttle = 30},
+            // while an update is running only the latest event per buffer, window and kind waits for it,
+            // the ones it replaces would redraw a state that is already gone
+            rpc::SubscriptionOptions{
+                .coalesce = true,
+                .key =
+                    [](const nvim::Api::view& msg) {
+                        const auto ev = msg[0];
+                        auto key = std::hash<std::string_view>{}(ev.find("event")->str());
+                        key = key * 31 + ev.find("buf")->as<std::size_t>();
+                        return key * 31 + ev.find("win")->as<std::size_t>();
+                    },
             });
 
         while (gen) {
             auto msg = co_await gen;
-            const auto data = msg.as_vector().front().as_multimap();
-            const auto event = data.find("event")->second.as_string();
-            const auto buf = data.find("buf")->second.as_uint64_t();
+            const auto data = msg[0];
+            const auto event = data.find("event")->str();
+            const auto buf = data.find("buf")->as<int>();
 
             auto it = buffers.find(buf);
             if (it == buffers.end())
@@ -197,7 +211,7 @@ auto handle_markdown(nvim::Api& api, nvim::Graphics& remote, int augroup) -> boo
                 spdlog::debug("Entered window {}", msg);
                 co_await it->second.draw();
             } else if (event == "WinClosed") {
-                const auto win = std::stoi(data.find("file")->second.as_string());
+                const auto win = std::stoi(data.find("file")->as<std::string>());
                 spdlog::debug("Closed window {}, data {}", win, msg);
                 co_await it->second.clear(win);
             }
@@ -8,7 +8,10 @@
 #include <spdlog/spdlog.h>
 
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <sys/socket.h>
+#include <unistd.h>
 #include <utility>
 
 namespace kitty {
@@ -43,11 +46,17 @@ public:
 };
 
 Cursor::~Cursor() {
-    nvim_.stream() << "\0338" << std::flush; // restore pos
+    nvim_.stream() << "\0338"; // restore pos
+    if (nvim_.caps().synchronized_update)
+        nvim_.stream() << "\033[?2026l";
+    nvim_.stream() << std::flush;
 }
 
 Cursor::Cursor(nvim::Graphics& nvim, int x, int y)
     : nvim_{nvim} {
+    // the screen isn't redrawn with the cursor moved away if the terminal supports it
+    if (nvim_.caps().synchronized_update)
+        nvim_.stream() << "\033[?2026h";
     nvim_.stream() << "\0337";                         // save pos
     nvim_.stream() << "\033[" << y << ";" << x << "f"; // move
 }
@@ -66,6 +75,22 @@ auto Image::send() {
     cv::imencode(".png", image_, content, {cv::IMWRITE_PNG_COMPRESSION});
     spdlog::debug("[{}] Encoded image to png, size {}", id_, content.size());
 
+    if (nvim_.caps().kitty_files) {
+        // the terminal is on this host, it reads the file and deletes it, only its path goes through the tty
+        const auto path = std::filesystem::temp_directory_path() /
+                          fmt::format("tty-graphics-protocol-jupyter-{}-{}.png", getpid(), id_);
+        std::ofstream{path, std::ios::binary}.write(reinterpret_cast<const char*>(content.data()), content.size());
+
+        const auto name = path.string();
+        std::string encoded(boost::beast::detail::base64::encoded_size(name.size()), '\0');
+        encoded.resize(boost::beast::detail::base64::encode(encoded.data(), name.data(), name.size()));
+
+        Command c{nvim_, 'q', 2, 'a', 't', 't', 't', 'f', 100, 'C', 1, 'i', id_};
+        nvim_.stream() << ";" << encoded;
+        spdlog::debug("[{}] Sent image to neovim as file {}", id_, name);
+        return;
+    }
+
     std::vector<char> encoded(boost::beast::detail::base64::encoded_size(content.size()));
     boost::beast::detail::base64::encode(encoded.data(), content.data(), content.size());
 
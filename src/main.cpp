@@ -5,32 +5,57 @@
 #include "graphics.hpp"
 
 #include "spdlog/cfg/env.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 
-auto run() -> boost::cobalt::task<int> {
+#include <cstdlib>
+#include <string>
+
+auto run(std::string address) -> boost::cobalt::task<int> {
     spdlog::set_level(spdlog::level::debug);
     spdlog::cfg::load_env_levels();
-    spdlog::debug("starting");
+    spdlog::debug("starting, connecting to {}", address);
 
-    auto api = co_await nvim::Api::create("localhost", 6666);
+    auto api = co_await nvim::Api::create(std::move(address));
+    if (const char* path = std::getenv("JUPYTER_NVIM_RECORD")) {
+        // traffic log for `replay`
+        spdlog::info("Recording RPC traffic to {}", path);
+        api.record(path);
+    } else {
+        // a recording covers one connection, so bulk calls stay on the interactive one while recording
+        co_await api.open_bulk_lane();
+    }
+    // :lua print(vim.rpcrequest(channel, "jupyter_metrics"))
+    api.serve("jupyter_metrics", [&api](auto) -> boost::cobalt::task<nvim::Api::any> {
+        co_return api.metrics_report();
+    });
+    // images and windows ask for the same window state in the same tick
+    api.enable_single_flight();
     auto graphics = nvim::Graphics{api};
     co_await graphics.init();
 
     const auto augroup = co_await api.nvim_create_augroup("jupyter", {});
+    co_await api.enable_state_cache(augroup);
     co_await boost::cobalt::join(jupyter::handle_images(api, graphics, augroup),
-                                 jupyter::handle_markdown(api, graphics, augroup));
+                                 jupyter::handle_markdown(api, graphics, augroup), graphics.handle_layout(augroup));
 
     co_return 0;
 }
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    // address from the command line, "stdio" when started by jobstart({rpc = true}),
+    // otherwise the server of the Neovim we run in
+    const char* nvim = std::getenv("NVIM");
+    std::string address = argc > 1 ? argv[1] : nvim ? nvim : "localhost:6666";
+    if (address == "stdio" || address == "-") {
+        // stdout belongs to the RPC channel
+        spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+    }
 
     auto& ctx = nvim::ExecutorSingleton::context();
     boost::cobalt::this_thread::set_executor(ctx.get_executor());
     try {
-        auto f = boost::cobalt::spawn(ctx, run(), boost::asio::use_future);
+        auto f = boost::cobalt::spawn(ctx, run(std::move(address)), boost::asio::use_future);
         ctx.run();
         return f.get();
     } catch (const std::exception& e) {
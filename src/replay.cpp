@@ -0,0 +1,97 @@
+#include "api.hpp"
+#include "executor.hpp"
+#include "fake/replay.hpp"
+#include "fake/server.hpp"
+#include "graphics.hpp"
+#include "handlers/images.hpp"
+#include "handlers/markdown.hpp"
+#include "recorder.hpp"
+
+#include "spdlog/cfg/env.h"
+#include "spdlog/spdlog.h"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+// Replays a session recorded with JUPYTER_NVIM_RECORD=<file> into the handlers, without Neovim or a terminal.
+// Usage: replay <recording> [speed], speed 1 is the recorded pace, 10 is 10x the event rate, 0 is as fast as possible.
+
+namespace {
+
+auto run(std::string path, double speed) -> boost::cobalt::task<void> {
+    fake::Server server{co_await boost::asio::this_coro::executor};
+    fake::Replayer replayer{server, rpc::Recorder::read(path)};
+    spdlog::info("Replaying {} notifications from {}", replayer.notifications(), path);
+
+    // started first, startup of the graphics waits for recorded notifications as well
+    auto playing = replayer.play(speed);
+
+    // same setup as the plugin, so the client makes the requests the recording expects
+    auto api = co_await nvim::Api::create(server.address());
+    api.enable_single_flight();
+    auto graphics = nvim::Graphics{api, 5, "/dev/null"};
+    co_await graphics.init();
+
+    const auto augroup = co_await api.nvim_create_augroup("jupyter", {});
+    co_await api.enable_state_cache(augroup);
+    // the handlers run until the replay is done, then they are cancelled
+    auto images = jupyter::handle_images(api, graphics, augroup);
+    auto markdown = jupyter::handle_markdown(api, graphics, augroup);
+    auto layout = graphics.handle_layout(augroup);
+
+    const auto stats = co_await playing;
+    const auto ms = [](auto d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    fmt::print("notifications: {}, stalls: {}, recorded: {:.1f} ms, replayed: {:.1f} ms, {:.0f} events/s, "
+               "requests: {}\n",
+               stats.notifications, stats.stalls, ms(stats.recorded), ms(stats.replayed),
+               stats.notifications / std::chrono::duration<double>(stats.replayed).count(), server.requests());
+
+    // The handlers refer to the api, the graphics and the server, they finish before those go out of scope.
+    // Closing the connections ends their autocmds, the errors they end with don't matter anymore.
+    images.cancel();
+    markdown.cancel();
+    layout.cancel();
+    co_await server.stop();
+    co_await boost::cobalt::gather(images, markdown, layout);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fmt::print(stderr, "Usage: {} <recording> [speed]\n", argv[0]);
+        return 1;
+    }
+
+    spdlog::set_level(spdlog::level::warn);
+    spdlog::cfg::load_env_levels();
+
+    const auto speed = argc > 2 ? std::atof(argv[2]) : 1.0;
+
+    // the handlers run their processes on the shared context
+    auto& ctx = nvim::ExecutorSingleton::context();
+    boost::cobalt::this_thread::set_executor(ctx.get_executor());
+
+    std::exception_ptr error;
+    boost::cobalt::spawn(ctx, run(argv[1], speed), [&](std::exception_ptr e) {
+        error = e;
+        ctx.stop();
+    });
+    ctx.run();
+
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            spdlog::error(e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
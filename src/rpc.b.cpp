@@ -0,0 +1,133 @@
+#include "api.hpp"
+#include "fake/server.hpp"
+#include "rpc.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <string>
+#include <vector>
+
+// Throughput and latency of the RPC layer against the in-process fake server, no Neovim needed.
+// Usage: bench [calls]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+auto report(std::string_view name, std::size_t count, Clock::duration total, std::vector<Clock::duration> latencies)
+    -> void {
+    const auto seconds = std::chrono::duration<double>(total).count();
+    const auto us = [](Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    };
+
+    if (latencies.empty()) {
+        fmt::print("{:<28} {:>10.0f} /s\n", name, count / seconds);
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()))];
+    };
+    fmt::print("{:<28} {:>10.0f} /s  p50 {:>6} us  p99 {:>6} us  max {:>6} us\n", name, count / seconds,
+               us(percentile(0.5)), us(percentile(0.99)), us(latencies.back()));
+}
+
+// `callers` coroutines make `calls` calls in total, each one waits for its previous result
+auto calls(nvim::Api& api, std::string_view name, std::size_t calls, std::size_t callers)
+    -> boost::cobalt::task<void> {
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(calls);
+
+    const auto caller = [&](std::size_t count) -> boost::cobalt::promise<void> {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto start = Clock::now();
+            co_await api.nvim_get_current_line();
+            latencies.push_back(Clock::now() - start);
+        }
+    };
+
+    const auto start = Clock::now();
+    std::vector<boost::cobalt::promise<void>> running;
+    for (std::size_t i = 0; i < callers; ++i) {
+        running.push_back(caller(calls / callers));
+    }
+    co_await boost::cobalt::join(running);
+
+    report(name, latencies.size(), Clock::now() - start, std::move(latencies));
+}
+
+auto notifications(nvim::Api& api, fake::Server& server, std::size_t count) -> boost::cobalt::task<void> {
+    const auto id = api.next_notification_id();
+    auto events = api.notifications(id);
+
+    const auto start = Clock::now();
+    auto sending = server.stream(
+        std::to_string(id),
+        [](std::size_t i) {
+            return fake::pack(std::map<std::string, std::size_t>{{"buf", i}});
+        },
+        count, 0);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        co_await events;
+    }
+    co_await sending;
+
+    report("notifications", count, Clock::now() - start, {});
+}
+
+auto run(std::size_t count) -> boost::cobalt::task<void> {
+    fake::Server server{co_await boost::asio::this_coro::executor};
+    server.respond("nvim_get_current_line", std::string(80, 'x'));
+
+    auto api = co_await nvim::Api::create(server.address());
+
+    co_await calls(api, "sequential", count, 1);
+    co_await calls(api, "concurrent x64", count, 64);
+
+    server.set_latency(100us);
+    co_await calls(api, "concurrent x64, 100us", count, 64);
+    server.set_latency(0us);
+
+    co_await notifications(api, server, count * 5);
+
+    // 3MB responses, the receive buffer grows once instead of doubling up to it
+    server.respond("nvim_get_current_line", std::string(3 * 1024 * 1024, 'x'));
+    co_await calls(api, "3MB responses", count / 100, 1);
+
+    fmt::print("\n{}", api.metrics_report());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const auto count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000ul;
+
+    boost::asio::io_context ctx{BOOST_ASIO_CONCURRENCY_HINT_1};
+    boost::cobalt::this_thread::set_executor(ctx.get_executor());
+
+    std::exception_ptr error;
+    boost::cobalt::spawn(ctx, run(count), [&](std::exception_ptr e) {
+        error = e;
+        ctx.stop();
+    });
+    ctx.run();
+
+    if (error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            fmt::print(stderr, "{}\n", e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -21,7 +21,7 @@ auto Window::get(Graphics& api, int win) -> boost::cobalt::promise<Window> {
     if (it == cache_.end()) {
         auto [terminal_pos, nvim_pos, w, h, visible] = co_await boost::cobalt::join(
             api.position(win), api.api().nvim_win_get_position(win), api.api().nvim_win_get_width(win),
-            api.api().nvim_win_get_height(win), api.visible_area());
+            api.api().nvim_win_get_height(win), api.visible_area(win));
         auto offsets = Size{.w = terminal_pos.x - nvim_pos.x, .h = terminal_pos.y - nvim_pos.y};
 
         // convert to zero-based offsets, only need first line(?)
@@ -58,9 +58,9 @@ auto Window::update(Graphics& api, int win) -> boost::cobalt::promise<void> {
 }
 
 auto Window::update(Graphics& api) -> boost::cobalt::promise<bool> {
-    const auto out = co_await api.api().nvim_exec2("lua print(vim.fn['line']('w0'))", {{"output", true}});
+    const auto lines = co_await api.api().visible_lines(id_);
     const auto prev = visible_.first;
-    visible_.first = std::stoi(out.find("output")->second.as_string()) - 1;
+    visible_.first = lines.first - 1;
     visible_.second = visible_.first + size_.h;
     co_return prev == visible_.first;
 }